@@ -0,0 +1,72 @@
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+using namespace std;
+using namespace spacePig;
+
+#ifdef SPACEPIG_COUNT_ALLOCATIONS
+
+namespace {
+
+/** allocations made by this thread */
+thread_local unsigned long long allocations = 0;
+
+}
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = malloc(size ? size : 1)) {
+	return memory;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    allocations++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, const nothrow_t&) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, const nothrow_t&) noexcept {
+    free(memory);
+}
+
+bool spacePig::countingAllocations() noexcept {
+    return true;
+}
+
+unsigned long long spacePig::allocationCount() noexcept {
+    return allocations;
+}
+
+#else
+
+bool spacePig::countingAllocations() noexcept {
+    return false;
+}
+
+unsigned long long spacePig::allocationCount() noexcept {
+    return 0;
+}
+
+#endif
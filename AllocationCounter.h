@@ -0,0 +1,23 @@
+#ifndef SPACEPIG_ALLOCATIONCOUNTER_H
+#define SPACEPIG_ALLOCATIONCOUNTER_H
+
+namespace spacePig {
+
+/**
+ * Whether this build counts heap allocations. Builds with
+ * SPACEPIG_COUNT_ALLOCATIONS defined replace the global operator new
+ * with one that counts; other builds do not count at all.
+ * @return true if allocations are counted
+ */
+bool countingAllocations() noexcept;
+
+/**
+ * The number of heap allocations the calling thread has made so far.
+ * Always 0 unless allocations are counted.
+ * @return the allocation count
+ */
+unsigned long long allocationCount() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cstdint>
+#include "Arena.h"
+
+using namespace std;
+using namespace spacePig;
+
+Arena::Arena(size_t blockSize) noexcept :
+    blockSize_(blockSize)
+    {}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+    // bump through the blocks in order, skipping the tail of any
+    // block the allocation does not fit in
+    for (; current_ < blocks_.size(); current_++, offset_ = 0) {
+	Block& block = blocks_[current_];
+	uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+	size_t start = size_t(((base + offset_ + align - 1) & ~uintptr_t(align - 1)) - base);
+	if (start + bytes <= block.size) {
+	    offset_ = start + bytes;
+	    used_ += bytes;
+	    return block.data.get() + start;
+	}
+    }
+
+    // nothing left fits, so add a block that does
+    size_t size = max(blockSize_, bytes + align);
+    blocks_.push_back(Block{ unique_ptr<char[]>(new char[size]), size });
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return allocate(bytes, align);
+}
+
+void Arena::reset() noexcept {
+    // fold the blocks into one, so the next round that needs as much
+    // fits without allocating again
+    if (blocks_.size() > 1) {
+	blockSize_ = max(blockSize_, capacity());
+	blocks_.clear();
+    }
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+size_t Arena::used() const noexcept {
+    return used_;
+}
+
+size_t Arena::capacity() const noexcept {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+	total += block.size;
+    }
+    return total;
+}
@@ -0,0 +1,153 @@
+#ifndef SPACEPIG_ARENA_H
+#define SPACEPIG_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace spacePig {
+
+/**
+ * A bump allocator. Allocating moves a cursor through a few large
+ * blocks, freeing does nothing, and reset() hands everything back at
+ * once. The blocks are kept across resets, so once an arena has seen
+ * its largest round of use, later rounds allocate nothing from the
+ * heap.
+ *
+ * An arena is not synchronized: use each one from one thread at a time.
+ */
+class Arena {
+public:
+    /**
+     * Construct an arena. No memory is taken until the first allocation.
+     */
+    explicit Arena(/** bytes in each block */ std::size_t blockSize = 64 * 1024) noexcept;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Take memory from the arena. It stays valid until the next reset().
+     * @return the memory
+     * @throw bad_alloc if a new block was needed and could not be allocated.
+     */
+    void* allocate(/** number of bytes */ std::size_t bytes,
+	    /** alignment, a power of two */ std::size_t align = alignof(std::max_align_t));
+
+    /**
+     * Hand back everything allocated. If the last round needed more
+     * than one block, the blocks are replaced by a single one as big
+     * as all of them, taken at the next allocation.
+     */
+    void reset() noexcept;
+
+    /**
+     * The number of bytes allocated since the last reset.
+     * @return the bytes in use
+     */
+    std::size_t used() const noexcept;
+
+    /**
+     * The number of bytes held in blocks.
+     * @return the bytes held
+     */
+    std::size_t capacity() const noexcept;
+
+private:
+    /** One run of memory the cursor moves through */
+    struct Block {
+	/** the memory */
+	std::unique_ptr<char[]> data;
+
+	/** its size in bytes */
+	std::size_t size;
+    };
+
+    /** the blocks, in the order the cursor visits them */
+    std::vector<Block> blocks_;
+
+    /** index of the block the cursor is in */
+    std::size_t current_ = 0;
+
+    /** offset of the cursor in that block */
+    std::size_t offset_ = 0;
+
+    /** bytes allocated since the last reset */
+    std::size_t used_ = 0;
+
+    /** size of the next block to be added */
+    std::size_t blockSize_;
+};
+
+/**
+ * A standard allocator drawing from an arena, or from the heap when
+ * given none. Containers moved or swapped take their arena with them.
+ * Copying a container gives the copy heap storage, so it does not
+ * depend on the original's arena.
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    typedef std::false_type propagate_on_container_copy_assignment;
+
+    /**
+     * Construct an allocator over an arena, or over the heap if null.
+     */
+    explicit ArenaAllocator(/** arena to draw from */ Arena* arena = nullptr) noexcept :
+	arena_(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+	arena_(other.arena()) {}
+
+    T* allocate(std::size_t count) {
+	if (arena_) {
+	    return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+	}
+	return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t) noexcept {
+	if (!arena_) {
+	    ::operator delete(pointer);
+	}
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const noexcept {
+	return ArenaAllocator();
+    }
+
+    /**
+     * The arena drawn from.
+     * @return the arena, or null for the heap
+     */
+    Arena* arena() const noexcept {
+	return arena_;
+    }
+
+private:
+    /** arena drawn from, null for the heap */
+    Arena* arena_;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.arena() == b.arena();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.arena() != b.arena();
+}
+
+/** A vector whose storage can come from an arena */
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+#include "AssetManager.h"
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** pixels left empty around each packed sprite to stop bleeding */
+const int padding = 1;
+
+/**
+ * Decode an image and convert it to the format textures are made in,
+ * so the upload on the render thread is a plain copy.
+ */
+SDL_Surface* decodeImage(const string& fileLocation, string& error) {
+    SDL_Surface* decoded = IMG_Load(fileLocation.c_str());
+    if (!decoded) {
+	error = SDL_GetError();
+	return nullptr;
+    }
+    if (decoded->format->format == SDL_PIXELFORMAT_ARGB8888) {
+	return decoded;
+    }
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(decoded);
+    if (!converted) {
+	error = SDL_GetError();
+    }
+    return converted;
+}
+
+}
+
+AssetManager::AssetManager(int atlasMaxSprite, int atlasWidth) :
+    atlasMaxSprite_(atlasMaxSprite),
+    atlasWidth_(atlasWidth)
+    {}
+
+AssetManager::~AssetManager() {
+    clear();
+}
+
+int AssetManager::load(const string& fileLocation) noexcept {
+    auto found = handles_.find(fileLocation);
+    if (found != handles_.end()) {
+	return found->second;
+    }
+
+    int handle = int(sprites_.size());
+    sprites_.push_back(Sprite());
+    handles_[fileLocation] = handle;
+    startLoad(handle, fileLocation);
+    return handle;
+}
+
+void AssetManager::startLoad(int handle, const string& fileLocation) noexcept {
+    pending_.resize(sprites_.size());
+    pending_[handle].reset(new Decode());
+    Decode* decode = pending_[handle].get();
+    decode->fileLocation = fileLocation;
+
+    // An image in the pack is ready as it is, so the surface just
+    // points into the mapped file
+
+    const AssetPack::Image* packed = pack_.find(fileLocation);
+    if (packed) {
+	decode->surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<void*>(packed->pixels),
+	    packed->width, packed->height, 32, packed->pitch, SDL_PIXELFORMAT_ARGB8888);
+	if (!decode->surface) {
+	    decode->error = SDL_GetError();
+	}
+	return;
+    }
+
+    // Set up the decoders once. SDL_image sets up each format the
+    // first time it is used, which is not safe to race, so the formats
+    // are set up here before any worker can decode
+
+    if (!decoders_) {
+	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+	try {
+	    decoders_.reset(new ThreadPool());
+	}
+	catch (const system_error&) {
+	    // no threads to be had, so decode on this one
+	}
+    }
+
+    // Decode the image from the file
+
+    auto work = [decode] {
+	decode->surface = decodeImage(decode->fileLocation, decode->error);
+    };
+    if (decoders_) {
+	decoders_->submit(work);
+    }
+    else {
+	work();
+    }
+}
+
+bool AssetManager::openPack(const string& path) noexcept {
+    return pack_.open(path);
+}
+
+bool AssetManager::build(SDL_Renderer* renderer) noexcept {
+    bool uploaded = true;
+
+    // Wait for the decoding to finish. The workers are only needed
+    // while images decode, so they go too
+
+    decoders_.reset();
+
+    // Take the decoded images, reporting any that failed
+
+    vector<SDL_Surface*> decoded(sprites_.size(), nullptr);
+    for (int handle = 0; handle < int(pending_.size()); handle++) {
+	unique_ptr<Decode> decode = move(pending_[handle]);
+	if (!decode) {
+	    continue;
+	}
+	if (!decode->surface) {
+	    cerr << "Unable to load the image file at " << decode->fileLocation
+		 << " due to: " << decode->error << endl;
+	    uploaded = false;
+	    continue;
+	}
+	decoded[handle] = decode->surface;
+	sprites_[handle].width = decode->surface->w;
+	sprites_[handle].height = decode->surface->h;
+    }
+
+    // Large images get a texture of their own
+
+    vector<int> small;
+    for (int handle = 0; handle < int(decoded.size()); handle++) {
+	SDL_Surface* surface = decoded[handle];
+	if (!surface) {
+	    continue;
+	}
+	if (surface->w <= atlasMaxSprite_ && surface->h <= atlasMaxSprite_) {
+	    small.push_back(handle);
+	    continue;
+	}
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+	if (texture) {
+	    textures_.push_back(texture);
+	    sprites_[handle].texture = texture;
+	}
+	else {
+	    cerr << "Unable to create a texture due to: " << SDL_GetError() << endl;
+	    uploaded = false;
+	}
+	SDL_FreeSurface(surface);
+	decoded[handle] = nullptr;
+    }
+    if (small.empty()) {
+	return uploaded;
+    }
+
+    // Shelf-pack the small images, tallest first, into rows no wider
+    // than the atlas
+
+    sort(small.begin(), small.end(), [&decoded](int a, int b) {
+	return decoded[a]->h > decoded[b]->h;
+    });
+    vector<SDL_Rect> placed(sprites_.size());
+    int x = padding;
+    int y = padding;
+    int shelf = 0;
+    int widest = 0;
+    for (int handle : small) {
+	SDL_Surface* surface = decoded[handle];
+	if (x + surface->w + padding > atlasWidth_) {
+	    x = padding;
+	    y += shelf + padding;
+	    shelf = 0;
+	}
+	placed[handle] = SDL_Rect{ x, y, surface->w, surface->h };
+	x += surface->w + padding;
+	shelf = max(shelf, surface->h);
+	widest = max(widest, x);
+    }
+    int atlasWidth = widest;
+    int atlasHeight = y + shelf + padding;
+
+    // Copy the images into one surface, alpha and all, and upload it
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight,
+	32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Texture* texture = nullptr;
+    if (atlas) {
+	for (int handle : small) {
+	    SDL_SetSurfaceBlendMode(decoded[handle], SDL_BLENDMODE_NONE);
+	    SDL_BlitSurface(decoded[handle], nullptr, atlas, &placed[handle]);
+	}
+	texture = SDL_CreateTextureFromSurface(renderer, atlas);
+	SDL_FreeSurface(atlas);
+    }
+    if (texture) {
+	textures_.push_back(texture);
+	for (int handle : small) {
+	    Sprite& sprite = sprites_[handle];
+	    sprite.texture = texture;
+	    sprite.u = float(placed[handle].x) / atlasWidth;
+	    sprite.v = float(placed[handle].y) / atlasHeight;
+	    sprite.du = float(placed[handle].w) / atlasWidth;
+	    sprite.dv = float(placed[handle].h) / atlasHeight;
+	}
+    }
+    else {
+	cerr << "Unable to create the sprite atlas due to: " << SDL_GetError() << endl;
+	uploaded = false;
+    }
+
+    // The surfaces are no longer needed
+
+    for (int handle : small) {
+	SDL_FreeSurface(decoded[handle]);
+	decoded[handle] = nullptr;
+    }
+    return uploaded;
+}
+
+const Sprite& AssetManager::get(int handle) const {
+    if (handle < 0 || handle >= int(sprites_.size()) || !sprites_[handle].texture) {
+	throw domain_error("Invalid image handle " + to_string(handle));
+    }
+    return sprites_[handle];
+}
+
+bool AssetManager::reload(SDL_Renderer* renderer) noexcept {
+    // Forget the textures and any images still on their way
+
+    if (decoders_) {
+	decoders_->wait();
+    }
+    for (const unique_ptr<Decode>& decode : pending_) {
+	if (decode && decode->surface) {
+	    SDL_FreeSurface(decode->surface);
+	}
+    }
+    pending_.clear();
+    for (SDL_Texture* texture : textures_) {
+	SDL_DestroyTexture(texture);
+    }
+    textures_.clear();
+
+    // then load every image again under the handle it already has
+
+    for (Sprite& sprite : sprites_) {
+	sprite = Sprite();
+    }
+    for (const auto& entry : handles_) {
+	startLoad(entry.second, entry.first);
+    }
+    return build(renderer);
+}
+
+int AssetManager::getTextureCount() const noexcept {
+    return int(textures_.size());
+}
+
+void AssetManager::clear() noexcept {
+    if (decoders_) {
+	decoders_->wait();
+    }
+    for (const unique_ptr<Decode>& decode : pending_) {
+	if (decode && decode->surface) {
+	    SDL_FreeSurface(decode->surface);
+	}
+    }
+    for (SDL_Texture* texture : textures_) {
+	SDL_DestroyTexture(texture);
+    }
+    pending_.clear();
+    textures_.clear();
+    sprites_.clear();
+    handles_.clear();
+}
@@ -0,0 +1,185 @@
+#ifndef SPACEPIG_ASSETMANAGER_H
+#define SPACEPIG_ASSETMANAGER_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AssetPack.h"
+
+struct SDL_Renderer;
+struct SDL_Surface;
+struct SDL_Texture;
+
+namespace spacePig {
+
+class ThreadPool;
+
+/**
+ * Where a sprite lives on the GPU, resolved once when the assets are
+ * built so that drawing needs no lookups.
+ */
+struct Sprite {
+    /** texture holding the sprite */
+    SDL_Texture* texture = nullptr;
+
+    /** left edge of the sprite in normalized texture coordinates */
+    float u = 0.0f;
+
+    /** top edge of the sprite in normalized texture coordinates */
+    float v = 0.0f;
+
+    /** width of the sprite in normalized texture coordinates */
+    float du = 1.0f;
+
+    /** height of the sprite in normalized texture coordinates */
+    float dv = 1.0f;
+
+    /** width of the sprite image in pixels */
+    int width = 0;
+
+    /** height of the sprite image in pixels */
+    int height = 0;
+};
+
+/**
+ * Loads every image the game draws, once.
+ * Images are keyed by file location, so asking for the same file twice
+ * returns the same handle. Small images are packed together into one
+ * atlas texture so sprites of different types can be drawn without
+ * switching textures; large images such as the background get a
+ * texture of their own.
+ *
+ * Images are decoded on worker threads as soon as they are loaded, so
+ * decoding overlaps with whatever the caller does next, such as
+ * creating the window and renderer. build() waits for the decoding and
+ * then uploads the textures on the calling thread, which must be the
+ * one that owns the renderer.
+ *
+ * Images found in an AssetPack opened with openPack() skip decoding
+ * altogether and are uploaded straight from the mapped file.
+ *
+ * Call load() for every image, then build() once before drawing.
+ */
+class AssetManager {
+public:
+    /** Handle returned when an image could not be loaded */
+    static const int invalid = -1;
+
+    /**
+     * Construct an empty asset manager. No renderer is needed until
+     * build(), so images can start decoding before there is one.
+     */
+    AssetManager(/** images no larger than this on either side are packed */ int atlasMaxSprite = 64,
+	    /** widest the atlas may be */ int atlasWidth = 512);
+
+    /**
+     * Wait for any decoding and destroy every texture.
+     */
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    /**
+     * Take images from a pack made by SpacePigPack rather than
+     * decoding them, for every load() from now on. The pack stays
+     * open until the asset manager is destroyed.
+     * @return false if the pack could not be opened, in which case
+     * images are decoded as usual
+     */
+    bool openPack(/** path of the pack */ const std::string& path) noexcept;
+
+    /**
+     * Take an image from the pack, or start decoding it on a worker
+     * thread, or find the one already loaded from the file. An image
+     * that fails to decode is reported by build(), and its handle
+     * never resolves.
+     * @return a handle to the sprite
+     */
+    int load(/** The location of the file. */ const std::string& fileLocation) noexcept;
+
+    /**
+     * Wait for the images loaded so far to decode, pack the small ones
+     * into the atlas and upload everything that is not on the GPU yet.
+     * @return true if every image was decoded and uploaded
+     */
+    bool build(/** renderer the textures are for */ SDL_Renderer* renderer) noexcept;
+
+    /**
+     * Make every texture again, for when the renderer has lost them
+     * all. Each image is loaded again, from the pack or its file, and
+     * keeps its handle.
+     * @return true if every image was decoded and uploaded
+     */
+    bool reload(/** renderer the textures are for */ SDL_Renderer* renderer) noexcept;
+
+    /**
+     * The sprite behind a handle. Only valid after build().
+     * @return the resolved sprite
+     */
+    const Sprite& get(/** handle from load() */ int handle) const;
+
+    /**
+     * The number of textures in use, atlas included.
+     * @return the texture count
+     */
+    int getTextureCount() const noexcept;
+
+    /**
+     * Wait for any decoding, destroy every texture and forget every
+     * image.
+     */
+    void clear() noexcept;
+
+private:
+    /** One image on its way to build(), from the pack or being decoded */
+    struct Decode {
+	/** the location of the file */
+	std::string fileLocation;
+
+	/** the decoded image, or null until decoded or if it failed */
+	SDL_Surface* surface = nullptr;
+
+	/** why decoding failed, if it did */
+	std::string error;
+    };
+
+    /** images no larger than this on either side are packed */
+    int atlasMaxSprite_ = 64;
+
+    /** widest the atlas may be */
+    int atlasWidth_ = 512;
+
+    /** images decoded ahead of time, if a pack was opened */
+    AssetPack pack_;
+
+    /** handle of every file loaded so far */
+    std::map<std::string, int> handles_;
+
+    /** sprite behind every handle */
+    std::vector<Sprite> sprites_;
+
+    /**
+     * images waiting for build(), by handle. Each is on the heap so a
+     * worker can fill it in while more are loaded.
+     */
+    std::vector<std::unique_ptr<Decode>> pending_;
+
+    /** workers decoding images, made on the first load() */
+    std::unique_ptr<ThreadPool> decoders_;
+
+    /** every texture created, for destruction */
+    std::vector<SDL_Texture*> textures_;
+
+    /**
+     * Take an image from the pack, or start decoding it, for build()
+     * to upload under a handle.
+     */
+    void startLoad(/** handle of the image */ int handle,
+	    /** The location of the file. */ const std::string& fileLocation) noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AssetPack.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+const char magic[4] = { 'S', 'P', 'A', 'K' };
+// version 2 records the pixel format and byte order
+const unsigned char version = 2;
+
+/** the pixel format code for 32-bit ARGB8888 words, the only one so far */
+const unsigned char formatArgb8888 = 1;
+
+/** the byte order codes */
+const unsigned char littleEndian = 1;
+const unsigned char bigEndian = 2;
+
+/** bytes before the index: magic, version, format, byte order, padding and image count */
+const size_t headerSize = 12;
+
+/** bytes in each index entry */
+const size_t entrySize = 32;
+
+/** every image's pixels start on a multiple of this many bytes */
+const size_t pixelAlignment = 64;
+
+void writeFixed(ostream& out, unsigned long long value, int bytes) {
+    for (int ii = 0; ii < bytes; ii++) {
+	out.put(char(value >> (8 * ii)));
+    }
+}
+
+unsigned long long readFixed(const unsigned char* at, int bytes) {
+    unsigned long long value = 0;
+    for (int ii = 0; ii < bytes; ii++) {
+	value |= (unsigned long long)at[ii] << (8 * ii);
+    }
+    return value;
+}
+
+size_t align(size_t offset) {
+    return (offset + pixelAlignment - 1) / pixelAlignment * pixelAlignment;
+}
+
+/**
+ * The byte order of this machine, which the pixel words are stored in.
+ * @return the byte order code
+ */
+unsigned char byteOrder() {
+    const unsigned int one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1 ? littleEndian : bigEndian;
+}
+
+}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const string& path) noexcept {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+	return false;
+    }
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length) || length.QuadPart <= 0
+	|| (unsigned long long)length.QuadPart > (unsigned long long)SIZE_MAX) {
+	CloseHandle(file);
+	return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // the view keeps the file and the mapping alive on its own
+    CloseHandle(file);
+    if (!mapping) {
+	return false;
+    }
+    void* mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!mapped) {
+	return false;
+    }
+    data_ = static_cast<const unsigned char*>(mapped);
+    size_ = size_t(length.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+	return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0) {
+	::close(file);
+	return false;
+    }
+    void* mapped = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps the file alive on its own
+    ::close(file);
+    if (mapped == MAP_FAILED) {
+	return false;
+    }
+    data_ = static_cast<const unsigned char*>(mapped);
+    size_ = size_t(status.st_size);
+#endif
+
+    if (!readIndex()) {
+	close();
+	return false;
+    }
+    return true;
+}
+
+bool AssetPack::readIndex() noexcept {
+    // the pixels are stored as words, so they can only be used as
+    // they are on a machine of the same byte order
+    if (size_ < headerSize || memcmp(data_, magic, sizeof(magic)) != 0
+	|| data_[4] != version || data_[5] != formatArgb8888 || data_[6] != byteOrder()) {
+	return false;
+    }
+    unsigned long long count = readFixed(data_ + 8, 4);
+    if (count > (size_ - headerSize) / entrySize) {
+	return false;
+    }
+
+    try {
+	for (unsigned long long ii = 0; ii < count; ii++) {
+	    const unsigned char* entry = data_ + headerSize + ii * entrySize;
+	    unsigned long long nameOffset = readFixed(entry, 4);
+	    unsigned long long nameLength = readFixed(entry + 4, 4);
+	    unsigned long long width = readFixed(entry + 8, 4);
+	    unsigned long long height = readFixed(entry + 12, 4);
+	    unsigned long long pitch = readFixed(entry + 16, 4);
+	    unsigned long long pixelOffset = readFixed(entry + 24, 8);
+
+	    // everything the entry points at has to lie inside the file
+	    if (nameOffset > size_ || nameLength > size_ - nameOffset
+		|| width == 0 || width > 0x7fffffff / 4 || pitch < width * 4
+		|| pitch > 0x7fffffff || height > 0x7fffffff
+		|| pixelOffset > size_ || height > (size_ - pixelOffset) / pitch) {
+		images_.clear();
+		return false;
+	    }
+
+	    Image image;
+	    image.width = int(width);
+	    image.height = int(height);
+	    image.pitch = int(pitch);
+	    image.pixels = data_ + pixelOffset;
+	    images_[string(reinterpret_cast<const char*>(data_ + nameOffset), size_t(nameLength))] = image;
+	}
+    }
+    catch (const exception&) {
+	images_.clear();
+	return false;
+    }
+    return true;
+}
+
+void AssetPack::close() noexcept {
+    images_.clear();
+    if (data_) {
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+#else
+	munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool AssetPack::isOpen() const noexcept {
+    return data_ != nullptr;
+}
+
+const AssetPack::Image* AssetPack::find(const string& fileLocation) const noexcept {
+    auto found = images_.find(fileLocation);
+    return found == images_.end() ? nullptr : &found->second;
+}
+
+int AssetPack::size() const noexcept {
+    return int(images_.size());
+}
+
+bool AssetPack::write(const string& path, const map<string, Image>& images) {
+    ofstream out(path, ios::binary);
+    if (!out) {
+	return false;
+    }
+
+    // Lay out the names after the index, then the pixels after the names
+
+    size_t nameOffset = headerSize + images.size() * entrySize;
+    size_t pixelOffset = nameOffset;
+    for (const auto& image : images) {
+	pixelOffset += image.first.size();
+    }
+    pixelOffset = align(pixelOffset);
+
+    out.write(magic, sizeof(magic));
+    out.put(char(version));
+    out.put(char(formatArgb8888));
+    out.put(char(byteOrder()));
+    out.put(0);
+    writeFixed(out, images.size(), 4);
+    for (const auto& image : images) {
+	writeFixed(out, nameOffset, 4);
+	writeFixed(out, image.first.size(), 4);
+	writeFixed(out, image.second.width, 4);
+	writeFixed(out, image.second.height, 4);
+	writeFixed(out, image.second.pitch, 4);
+	writeFixed(out, 0, 4);
+	writeFixed(out, pixelOffset, 8);
+	nameOffset += image.first.size();
+	pixelOffset = align(pixelOffset + size_t(image.second.pitch) * image.second.height);
+    }
+    for (const auto& image : images) {
+	out.write(image.first.data(), image.first.size());
+    }
+    for (const auto& image : images) {
+	if (!out) {
+	    return false;
+	}
+	for (size_t written = size_t(out.tellp()); written % pixelAlignment != 0; written++) {
+	    out.put(0);
+	}
+	out.write(static_cast<const char*>(image.second.pixels),
+	    streamsize(image.second.pitch) * image.second.height);
+    }
+    return bool(out);
+}
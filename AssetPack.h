@@ -0,0 +1,118 @@
+#ifndef SPACEPIG_ASSETPACK_H
+#define SPACEPIG_ASSETPACK_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace spacePig {
+
+/**
+ * A file of images decoded ahead of time by SpacePigPack, ready to be
+ * uploaded to textures as they are. The file is mapped into memory
+ * rather than read, with mmap or on Windows MapViewOfFile, so opening
+ * it costs next to nothing, and images
+ * are handed out as pointers into the mapping: nothing is decoded and
+ * nothing is copied until the texture upload.
+ *
+ * The file starts with the bytes "SPAK", a version byte, a pixel
+ * format byte (1 for ARGB8888), a byte order byte (1 for little
+ * endian, 2 for big), a zero byte and the number of images as 4
+ * bytes. An index of 32 bytes per
+ * image follows: the offset and length of its name, its width, height
+ * and pitch, 4 zero bytes, and the offset of its pixels as 8 bytes.
+ * The names come next, then the pixels of each image, starting on a
+ * 64-byte boundary. Multi-byte values in the header and index are
+ * little endian; the pixels are 32-bit words in the byte order the
+ * header records, and a pack of the other byte order is refused.
+ *
+ * A pack is a snapshot of the images it was made from, so it has to
+ * be made again whenever they change.
+ */
+class AssetPack {
+public:
+    /** One image in the pack */
+    struct Image {
+	/** width in pixels */
+	int width = 0;
+
+	/** height in pixels */
+	int height = 0;
+
+	/** bytes from the start of one row to the next */
+	int pitch = 0;
+
+	/** the first row of ARGB8888 pixels */
+	const void* pixels = nullptr;
+    };
+
+    /**
+     * Construct a pack with no file open.
+     */
+    AssetPack() = default;
+
+    /**
+     * Close the file, if one is open.
+     */
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    /**
+     * Map a pack file into memory and read its index, closing any
+     * file already open.
+     * @return false if the file is missing or is not a valid pack
+     */
+    bool open(/** path of the pack */ const std::string& path) noexcept;
+
+    /**
+     * Unmap the file. Pointers to its images are no longer valid.
+     */
+    void close() noexcept;
+
+    /**
+     * Whether or not a pack is open.
+     * @return true if a pack is open
+     */
+    bool isOpen() const noexcept;
+
+    /**
+     * Look up an image by the file location it was packed from.
+     * @return the image, or null if the pack does not hold it
+     */
+    const Image* find(/** The location of the file. */ const std::string& fileLocation) const noexcept;
+
+    /**
+     * The number of images in the pack.
+     * @return the image count
+     */
+    int size() const noexcept;
+
+    /**
+     * Write images out as a pack file.
+     * @return false if the file could not be written
+     */
+    static bool write(/** path of the pack */ const std::string& path,
+	    /** images keyed by the file location they came from */ const std::map<std::string, Image>& images);
+
+private:
+    /** the start of the file's contents, or null if no file is open */
+    const unsigned char* data_ = nullptr;
+
+    /** the size of the file in bytes */
+    std::size_t size_ = 0;
+
+    /** every image in the pack, keyed by the file location it came from */
+    std::map<std::string, Image> images_;
+
+    /**
+     * Read the index of the file at data_.
+     * @return false if the file is not a valid pack
+     */
+    bool readIndex() noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "BatchRunner.h"
+#include "GameSession.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** directions the autopilot can steer in, with 0 for standing still */
+const unsigned moves[] = { 0, Player::Left, Player::Right, Player::Up, Player::Down };
+
+/** how many steps ahead the autopilot follows the projectiles */
+const int lookahead = 8;
+
+/**
+ * Pick the move that keeps the player furthest from the projectiles
+ * over the next few steps, assuming they fly straight. Distances are
+ * measured the way CollisionGrid measures a hit: from the player's
+ * center to the projectile's rounded top-left corner, less the
+ * distance at which the two touch.
+ * @return the chosen directions
+ */
+unsigned autopilot(const GameSession& session) {
+    const Player& player = session.getPlayer();
+    Circle body = player.getBody();
+    // simulated seconds per step, and how far the player moves in one
+    double dt = session.getGameSpeed() / session.getTickRate();
+    double moveStep = player.getVelocity() * dt;
+
+    const ProjectilePool& pool = session.getWave().getReleased().pool();
+    const float* x = pool.posx();
+    const float* y = pool.posy();
+    const float* vx = pool.vx();
+    const float* vy = pool.vy();
+    const unsigned char* type = pool.type();
+    int count = pool.size();
+
+    // look each type's radius and touching distance up once
+    double radius[ProjectileTypes::capacity];
+    double touch[ProjectileTypes::capacity];
+    for (int id = 0; id < ProjectileTypes::size(); id++) {
+	radius[id] = ProjectileTypes::get(id).radius;
+	touch[id] = (int(2.0 * radius[id] + 0.5) / 2) + body.radius;
+    }
+
+    const double offsets[][2] = { {0, 0}, {-moveStep, 0}, {moveStep, 0}, 
+	{0, -moveStep}, {0, moveStep} };
+    int best = 0;
+    double bestClearance = -1e18;
+    for (int mm = 0; mm < 5; mm++) {
+	double cx = body.x + offsets[mm][0];
+	double cy = body.y + offsets[mm][1];
+	double clearance = 1e18;
+	for (int ii = 0; ii < count && clearance > bestClearance; ii++) {
+	    double nearest = 1e18;
+	    for (int ahead = 1; ahead <= lookahead; ++ahead) {
+		double dx = int(x[ii] + vx[ii] * dt * ahead - radius[type[ii]] + 0.5) - cx;
+		double dy = int(y[ii] + vy[ii] * dt * ahead - radius[type[ii]] + 0.5) - cy;
+		nearest = min(nearest, dx * dx + dy * dy);
+	    }
+	    clearance = min(clearance, sqrt(nearest) - touch[type[ii]]);
+	}
+	if (clearance > bestClearance) {
+	    bestClearance = clearance;
+	    best = mm;
+	}
+    }
+    return moves[best];
+}
+
+}
+
+BatchRunner::BatchRunner(int threads, unsigned long long maxTicks, double tickRate) :
+    pool_(threads),
+    maxTicks_(maxTicks),
+    tickRate_(tickRate)
+    {}
+
+unsigned BatchRunner::seedFor(unsigned baseSeed, int index) noexcept {
+    // SplitMix64 finalizer, so neighbouring games get unrelated seeds
+    unsigned long long z = (static_cast<unsigned long long>(baseSeed) << 32) 
+	+ unsigned(index) + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return unsigned(z ^ (z >> 31));
+}
+
+GameResult BatchRunner::play(const WaveParams& params, unsigned seed) const {
+    GameSession session(Player(), tickRate_, seed, params);
+    session.restart();
+    while (session.getState() != GameSession::State::Dead && 
+	session.getTick() < maxTicks_) {
+	session.steerPlayer(autopilot(session));
+	session.step();
+    }
+
+    GameResult result;
+    result.seed = seed;
+    result.wave = session.getWave().getWave();
+    result.ticks = session.getTick();
+    result.died = session.getState() == GameSession::State::Dead;
+    return result;
+}
+
+vector<GameResult> BatchRunner::run(const WaveParams& params, int games, unsigned baseSeed) {
+    // every game writes only its own slot, so no locking is needed
+    vector<GameResult> results(games);
+    for (int ii = 0; ii < games; ii++) {
+	pool_.submit([this, &results, &params, baseSeed, ii] {
+	    results[ii] = play(params, seedFor(baseSeed, ii));
+	});
+    }
+    pool_.wait();
+    return results;
+}
+
+BatchSummary BatchRunner::summarize(const WaveParams& params, int games, unsigned baseSeed) {
+    auto start = chrono::steady_clock::now();
+    vector<GameResult> results = run(params, games, baseSeed);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    BatchSummary summary;
+    summary.params = params;
+    summary.games = games;
+    summary.seconds = seconds;
+    if (games == 0) {
+	return summary;
+    }
+
+    vector<int> waves;
+    int survived = 0;
+    for (const GameResult& result : results) {
+	waves.push_back(result.wave);
+	summary.meanWave += result.wave;
+	summary.ticks += result.ticks;
+	if (!result.died) {
+	    survived++;
+	}
+    }
+    sort(waves.begin(), waves.end());
+    summary.meanWave /= games;
+    summary.medianWave = waves[games / 2];
+    summary.maxWave = waves.back();
+    summary.survivalRate = double(survived) / games;
+    summary.ticksPerSecond = seconds > 0 ? summary.ticks / seconds : 0.0;
+    return summary;
+}
+
+int BatchRunner::getThreadCount() const noexcept {
+    return pool_.size();
+}
@@ -0,0 +1,124 @@
+#ifndef SPACEPIG_BATCHRUNNER_H
+#define SPACEPIG_BATCHRUNNER_H
+
+#include <vector>
+#include "ThreadPool.h"
+#include "WaveParams.h"
+
+namespace spacePig {
+
+/**
+ * The outcome of one simulated game.
+ */
+struct GameResult {
+    /** seed the game was played with */
+    unsigned seed = 0;
+
+    /** the wave the game ended on */
+    int wave = 0;
+
+    /** simulation steps the game lasted */
+    unsigned long long ticks = 0;
+
+    /** whether the player died, rather than running out of time */
+    bool died = false;
+};
+
+/**
+ * Statistics over a batch of games played with the same parameters.
+ */
+struct BatchSummary {
+    /** parameters the games were played with */
+    WaveParams params;
+
+    /** number of games played */
+    int games = 0;
+
+    /** mean wave the games ended on */
+    double meanWave = 0.0;
+
+    /** median wave the games ended on */
+    int medianWave = 0;
+
+    /** furthest wave any game reached */
+    int maxWave = 0;
+
+    /** fraction of games that were still alive when time ran out */
+    double survivalRate = 0.0;
+
+    /** simulation steps run across every game */
+    unsigned long long ticks = 0;
+
+    /** wall-clock seconds the batch took */
+    double seconds = 0.0;
+
+    /** simulation steps per wall-clock second */
+    double ticksPerSecond = 0.0;
+};
+
+/**
+ * Plays many independent, seeded headless games in parallel.
+ * Each game is its own GameSession with its own state, steered by
+ * a simple dodging autopilot, and runs until the player dies or the
+ * tick limit is reached. Game i of a batch always gets the same seed
+ * for the same base seed, so batches are reproducible.
+ */
+class BatchRunner {
+public:
+    /**
+     * Construct a runner with its own worker threads.
+     */
+    BatchRunner(/** number of workers, 0 for one per core */ int threads = 0,
+	    /** most simulation steps a game may last */ unsigned long long maxTicks = 36000,
+	    /** simulation steps per second of game time */ double tickRate = 60.0);
+
+    /**
+     * Play a batch of games with the same parameters.
+     * @return the result of each game, in seed order
+     */
+    std::vector<GameResult> run(/** how to generate the waves */ const WaveParams& params,
+	    /** number of games */ int games,
+	    /** seed the per-game seeds are derived from */ unsigned baseSeed);
+
+    /**
+     * Play a batch of games and summarize them.
+     * @return statistics over the batch
+     */
+    BatchSummary summarize(/** how to generate the waves */ const WaveParams& params,
+	    /** number of games */ int games,
+	    /** seed the per-game seeds are derived from */ unsigned baseSeed);
+
+    /**
+     * Play one game to the end on the calling thread.
+     * @return the outcome of the game
+     */
+    GameResult play(/** how to generate the waves */ const WaveParams& params,
+	    /** seed of the game */ unsigned seed) const;
+
+    /**
+     * The number of worker threads.
+     * @return the worker count
+     */
+    int getThreadCount() const noexcept;
+
+    /**
+     * The seed game index of a batch is played with.
+     * @return the game's seed
+     */
+    static unsigned seedFor(/** the batch's base seed */ unsigned baseSeed,
+	    /** index of the game in the batch */ int index) noexcept;
+
+private:
+    /** workers the games run on */
+    ThreadPool pool_;
+
+    /** most simulation steps a game may last */
+    unsigned long long maxTicks_;
+
+    /** simulation steps per second of game time */
+    double tickRate_;
+};
+
+}
+
+#endif
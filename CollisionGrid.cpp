@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cmath>
+#include "CollisionGrid.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/**
+ * Whether a point starting at offset (dx, dy) from a circle's center
+ * and moving by (wx, wy) relative to it comes within touch of the
+ * center on the way.
+ */
+bool approaches(double dx, double dy, double wx, double wy, double touch) noexcept {
+    // the closest point is where the offset is square to the motion,
+    // clamped to the ends of the move
+    double w2 = wx * wx + wy * wy;
+    double s = w2 > 0.0 ? min(max(-(dx * wx + dy * wy) / w2, 0.0), 1.0) : 0.0;
+    double x = dx + s * wx;
+    double y = dy + s * wy;
+    return x * x + y * y < touch * touch;
+}
+
+}
+
+CollisionGrid::CollisionGrid(int width, int height, int cellSize, Arena* arena) :
+    cellSize_(cellSize),
+    cols_((width + cellSize - 1) / cellSize),
+    rows_((height + cellSize - 1) / cellSize),
+    cellStart_(ArenaAllocator<int>(arena)),
+    entries_(ArenaAllocator<int>(arena)),
+    cellOf_(ArenaAllocator<int>(arena))
+    {}
+
+int CollisionGrid::column(double x) const noexcept {
+    int col = int(floor(x / cellSize_));
+    return min(max(col, 0), cols_ - 1);
+}
+
+int CollisionGrid::row(double y) const noexcept {
+    int r = int(floor(y / cellSize_));
+    return min(max(r, 0), rows_ - 1);
+}
+
+void CollisionGrid::reserve(int count) {
+    cellStart_.reserve(cols_ * rows_ + 1);
+    cellOf_.reserve(count);
+    entries_.reserve(count);
+}
+
+void CollisionGrid::rebuild(const ProjectilePool& pool) {
+    int count = pool.size();
+    if (count == 0) {
+	// nothing to hit, which collides() and sweeps() see without
+	// the cells having to be laid out
+	cellStart_.clear();
+	maxHalfDiameter_ = 0;
+	maxTravel_ = 0.0;
+	return;
+    }
+    const float* posx = pool.posx();
+    const float* posy = pool.posy();
+    const float* vx = pool.vx();
+    const float* vy = pool.vy();
+    const unsigned char* type = pool.type();
+    cellOf_.resize(count);
+    entries_.resize(count);
+    // zero the counts in place, within the room reserve() made
+    cellStart_.resize(cols_ * rows_ + 1);
+    fill(cellStart_.begin(), cellStart_.end(), 0);
+    maxHalfDiameter_ = 0;
+    double maxSpeed2 = 0.0;
+
+    // look each type's radius up once, rather than once per projectile
+    for (int id = 0; id < ProjectileTypes::size(); id++) {
+	typeRadius_[id] = ProjectileTypes::get(id).radius;
+    }
+
+    // count the projectiles in each cell, bucketing each by the
+    // same point the collision test uses, the top left corner
+    // that ProjectileRef::getX and getY round to
+    for (int ii = 0; ii < count; ii++) {
+	double radius = typeRadius_[type[ii]];
+	int x = int(posx[ii] - radius + 0.5);
+	int y = int(posy[ii] - radius + 0.5);
+	int cell = row(y) * cols_ + column(x);
+	cellOf_[ii] = cell;
+	cellStart_[cell + 1]++;
+	maxHalfDiameter_ = max(maxHalfDiameter_, int(2.0 * radius + 0.5) / 2);
+	maxSpeed2 = max(maxSpeed2, double(vx[ii]) * vx[ii] + double(vy[ii]) * vy[ii]);
+    }
+    maxTravel_ = sqrt(maxSpeed2) * pool.getStepDelta();
+
+    // turn the counts into the start of each cell's run
+    for (int cell = 0; cell < cols_ * rows_; cell++) {
+	cellStart_[cell + 1] += cellStart_[cell];
+    }
+
+    // scatter the projectiles into their runs, using cellStart_ as a
+    // cursor and restoring it afterwards
+    for (int ii = 0; ii < count; ii++) {
+	entries_[cellStart_[cellOf_[ii]]++] = ii;
+    }
+    for (int cell = cols_ * rows_; cell > 0; cell--) {
+	cellStart_[cell] = cellStart_[cell - 1];
+    }
+    cellStart_[0] = 0;
+}
+
+bool CollisionGrid::collides(const ProjectilePool& pool, const Circle* circles, 
+    int count) const noexcept {
+    if (cellStart_.empty()) {
+	// never built or empty, so there is nothing to hit
+	return false;
+    }
+    ProjectileView projectiles = pool.view();
+    for (int cc = 0; cc < count; cc++) {
+	const Circle& circle = circles[cc];
+
+	// only visit the cells any touching projectile could be in
+	double reach = circle.radius + maxHalfDiameter_;
+	int colLo = column(circle.x - reach);
+	int colHi = column(circle.x + reach);
+	int rowLo = row(circle.y - reach);
+	int rowHi = row(circle.y + reach);
+
+	for (int r = rowLo; r <= rowHi; r++) {
+	    for (int col = colLo; col <= colHi; col++) {
+		int cell = r * cols_ + col;
+		for (int ee = cellStart_[cell]; ee < cellStart_[cell + 1]; ee++) {
+		    ProjectileRef proj = projectiles[entries_[ee]];
+		    double dx = proj.getX() - circle.x;
+		    double dy = proj.getY() - circle.y;
+		    double dist2 = dx * dx + dy * dy;
+		    double touch = (proj.getDiameter() / 2) + circle.radius;
+		    if (dist2 < touch * touch) {
+			return true;
+		    }
+		}
+	    }
+	}
+    }
+    return false;
+}
+
+bool CollisionGrid::sweeps(const ProjectilePool& pool, const Circle* from,
+    const Circle* to, int count) const noexcept {
+    if (cellStart_.empty()) {
+	// never built or empty, so there is nothing to hit
+	return false;
+    }
+    const float* prevx = pool.prevx();
+    const float* prevy = pool.prevy();
+    const float* posx = pool.posx();
+    const float* posy = pool.posy();
+    const float* vx = pool.vx();
+    const unsigned char* type = pool.type();
+    float delta = pool.getStepDelta();
+    for (int cc = 0; cc < count; cc++) {
+	const Circle& start = from[cc];
+	const Circle& end = to[cc];
+
+	// only visit the cells a projectile that touched the circle
+	// anywhere along its move could have ended the step in, allowing
+	// for the rounding of the point the grid buckets by
+	double reach = max(start.radius, end.radius) + maxHalfDiameter_ + maxTravel_ + 1.0;
+	int colLo = column(min(start.x, end.x) - reach);
+	int colHi = column(max(start.x, end.x) + reach);
+	int rowLo = row(min(start.y, end.y) - reach);
+	int rowHi = row(max(start.y, end.y) + reach);
+	double moveX = end.x - start.x;
+	double moveY = end.y - start.y;
+
+	for (int r = rowLo; r <= rowHi; r++) {
+	    for (int col = colLo; col <= colHi; col++) {
+		int cell = r * cols_ + col;
+		for (int ee = cellStart_[cell]; ee < cellStart_[cell + 1]; ee++) {
+		    // follow the same point as collides(), the top left
+		    // corner, from where it started the step to where it
+		    // ended it, relative to the circle
+		    int ii = entries_[ee];
+		    double radius = typeRadius_[type[ii]];
+		    double touch = (int(2.0 * radius + 0.5) / 2) + end.radius;
+		    double dx = prevx[ii] - radius - start.x;
+		    double dy = prevy[ii] - radius - start.y;
+		    double wx = posx[ii] - prevx[ii] - moveX;
+		    double wy = posy[ii] - prevy[ii] - moveY;
+
+		    float bounce = pool.getBounceTime(ii);
+		    if (bounce < 0.0f) {
+			if (approaches(dx, dy, wx, wy, touch)) {
+			    return true;
+			}
+			continue;
+		    }
+
+		    // up to the wall and back out again, as two straight moves
+		    double toWall = -double(delta) * vx[ii] * bounce;
+		    double wallX = toWall - moveX * bounce;
+		    double wallY = wy * bounce;
+		    if (approaches(dx, dy, wallX, wallY, touch)
+			|| approaches(dx + wallX, dy + wallY, wx - wallX, wy - wallY, touch)) {
+			return true;
+		    }
+		}
+	    }
+	}
+    }
+    return false;
+}
@@ -0,0 +1,127 @@
+#ifndef SPACEPIG_COLLISIONGRID_H
+#define SPACEPIG_COLLISIONGRID_H
+
+#include "Arena.h"
+#include "ProjectilePool.h"
+
+namespace spacePig {
+
+/**
+ * A circle to test against the projectiles of a wave, such as a
+ * player's hitbox.
+ */
+struct Circle {
+    /** x-coordinate of the center */
+    double x;
+
+    /** y-coordinate of the center */
+    double y;
+
+    /** radius of the circle */
+    double radius;
+};
+
+/**
+ * A uniform grid over the screen used as the broad phase for
+ * collisions between circles and the projectiles of a pool.
+ * The grid buckets projectile indices by cell, so a query only
+ * tests the projectiles in the cells a circle overlaps. Projectiles
+ * outside the screen are kept in the nearest border cell.
+ * The grid must be rebuilt whenever the pool changes. Its buckets
+ * can be drawn from an arena, and take no memory until first used.
+ */
+class CollisionGrid {
+public:
+    /**
+     * Construct an empty grid covering the screen.
+     */
+    CollisionGrid(/** width of the screen */ int width = 450,
+		/** height of the screen */ int height = 800,
+		/** side of one square cell */ int cellSize = 32,
+		/** arena to store the buckets in, or null for the heap */
+		Arena* arena = nullptr);
+
+    /**
+     * Make room to index a number of projectiles without reallocating.
+     */
+    void reserve(/** number of projectiles */ int count);
+
+    /**
+     * Bucket every projectile of a pool into its cell.
+     * Takes time proportional to the number of projectiles.
+     */
+    void rebuild(/** pool to index */ const ProjectilePool& pool);
+
+    /**
+     * Check whether any of the circles overlaps a projectile of the
+     * pool the grid was last rebuilt from.
+     * @return true if there is a collision
+     */
+    bool collides(/** pool the grid was built from */ const ProjectilePool& pool,
+		/** circles to test */ const Circle* circles,
+		/** number of circles */ int count) const noexcept;
+
+    /**
+     * Check whether any of the circles touched a projectile at any
+     * time during the last step of the pool the grid was last rebuilt
+     * from. Each circle moves in a straight line from its start to its
+     * end over the step, and each projectile follows its own path over
+     * the step, bouncing off the walls, so nothing slips between the
+     * positions at either end of a long step.
+     * @return true if there is a collision
+     */
+    bool sweeps(/** pool the grid was built from */ const ProjectilePool& pool,
+		/** circles at the start of the step */ const Circle* from,
+		/** the same circles at the end of the step */ const Circle* to,
+		/** number of circles */ int count) const noexcept;
+
+private:
+    /** side of one square cell */
+    int cellSize_ = 32;
+
+    /** number of cell columns */
+    int cols_ = 0;
+
+    /** number of cell rows */
+    int rows_ = 0;
+
+    /** largest half diameter of any indexed projectile */
+    int maxHalfDiameter_ = 0;
+
+    /** farthest any indexed projectile moved in the pool's last step */
+    double maxTravel_ = 0.0;
+
+    /** 
+     * start of each cell's run in entries_, with one extra
+     * entry marking the end of the last cell
+     */
+    ArenaVector<int> cellStart_;
+
+    /** projectile indices ordered by cell */
+    ArenaVector<int> entries_;
+
+    /** cell of each projectile, scratch space for rebuild */
+    ArenaVector<int> cellOf_;
+
+    /**
+     * radius of each projectile type, scratch space for rebuild with
+     * room for every type that can be registered
+     */
+    double typeRadius_[ProjectileTypes::capacity];
+
+    /**
+     * The column holding an x-coordinate, clamped to the grid.
+     * @return the column index
+     */
+    int column(/** x-coordinate */ double x) const noexcept;
+
+    /**
+     * The row holding a y-coordinate, clamped to the grid.
+     * @return the row index
+     */
+    int row(/** y-coordinate */ double y) const noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef SPACEPIG_COUNTERRNG_H
+#define SPACEPIG_COUNTERRNG_H
+
+namespace spacePig {
+
+/**
+ * A counter-based random number generator. Each stream is keyed by a
+ * seed, a wave number and an index, and its n-th value is a SplitMix64
+ * hash of the key and n, so any value of any stream can be computed
+ * on its own without stepping through the ones before it. The whole
+ * generator is a key and a counter.
+ */
+class CounterRng {
+public:
+    CounterRng(/** seed of the game */ unsigned seed,
+	    /** wave number */ int wave,
+	    /** index of the stream within the wave */ unsigned long long index) noexcept :
+	key_(mix(mix(mix(seed) ^ (unsigned long long)(wave)) ^ index))
+	{}
+
+    /**
+     * The value at a position of the stream, without moving along it.
+     * @return 64 random bits
+     */
+    unsigned long long at(/** position in the stream */ unsigned long long counter) const noexcept {
+	return mix(key_ + counter * golden);
+    }
+
+    /**
+     * The next value of the stream.
+     * @return 64 random bits
+     */
+    unsigned long long next() noexcept {
+	return at(++counter_);
+    }
+
+    /**
+     * The next value of the stream as a double in [0, 1).
+     * @return a uniform double
+     */
+    double nextDouble() noexcept {
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    /** the Weyl increment of SplitMix64, 2^64 over the golden ratio */
+    static const unsigned long long golden = 0x9e3779b97f4a7c15ULL;
+
+    /** hash identifying the stream */
+    unsigned long long key_;
+
+    /** position of the last value drawn */
+    unsigned long long counter_ = 0;
+
+    /** the SplitMix64 finalizer */
+    static unsigned long long mix(unsigned long long z) noexcept {
+	z += golden;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+    }
+};
+
+}
+
+#endif
@@ -1,21 +1,50 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <chrono>
+#include <cmath>
 
 #include "Display.h"
+#include "AllocationCounter.h"
+#include "AssetManager.h"
+#include "LayerCache.h"
+#include "SpriteBatch.h"
 
 using namespace std;
 using namespace spacePig;
 
 GameDisplay::GameDisplay(Player player, int width, int height)
-  : player_(player), width_(width), height_(height) {
+  : width_(width), height_(height),
+    session_(player, 60.0, unsigned(chrono::system_clock::now().time_since_epoch().count())),
+    sim_(session_) {
 
-    // Initialize SDL2
+    startupBegin_ = chrono::steady_clock::now();
+    startupMark_ = startupBegin_;
+    startupPhases_.reserve(4);
+    session_.setPrefetchWaves(true);
 
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+    // Initialize only the video subsystem, which brings events with
+    // it. Audio, joysticks and the rest are never used and are slow
+    // to bring up
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
     	throw domain_error(string("SDL Initialization failed due to: ") + SDL_GetError());
     }
+    markStartup("video");
+
+    // add all necessary images. Those in the pack made by make assets
+    // need no decoding; the rest decode on worker threads while the
+    // window and renderer are made
+    assets_.reset(new AssetManager());
+    assets_->openPack("graphics/assets.pack");
+    backgroundImage_ = assets_->load("graphics/scene.jpg");
+    playerImage_ = assets_->load(session_.getPlayer().getFileLoc());
+    for (int type = 0; type < ProjectileTypes::size(); type++) {
+	projectileImages_.push_back(assets_->load(ProjectileTypes::get(type).fileLocation));
+	projectileRadii_.push_back(ProjectileTypes::get(type).radius);
+    }
 
     // Construct the screen window
 
@@ -27,20 +56,30 @@ GameDisplay::GameDisplay(Player player, int width, int height)
     	throw domain_error(string("Unable to create the window due to: ") + SDL_GetError());
     }
 
-    // Construct the renderer
+    // Construct the renderer and the sprite batch it draws from
 
     renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer_) {
     	close();
     	throw domain_error(string("Unable to create the renderer due to: ") + SDL_GetError());
     }
-    // add all necessary images
-    addImage("graphics/scene.jpg");
-    addImage(player_.getFileLoc());
-    for (auto proj : wave_.getWaiting()) {
-	addImage(proj.getFileLoc());
-	break;
-    }
+    batch_.reset(new SpriteBatch());
+    markStartup("window");
+
+    // upload the decoded images here on the render thread, packing
+    // the small sprites into one atlas texture
+    assets_->build(renderer_);
+    markStartup("assets");
+
+    // the background never changes, so it is painted once into the
+    // static layer cache rather than into every frame
+    layers_.reset(new LayerCache(renderer_, width_, height_));
+    backgroundLayer_ = layers_->addLayer([this](SDL_Renderer* renderer) {
+	SDL_Rect destination = { 0, 0, width_, height_ };
+	return SDL_RenderCopy(renderer, assets_->get(backgroundImage_).texture,
+	    nullptr, &destination);
+    });
+
     // Clear the window
 
     clearBackground();
@@ -55,16 +94,13 @@ void GameDisplay::close() noexcept {
     // Delete the SDL2 resources in reverse order of
     // their construction, starting with the images
 
-    for (SDL_Texture* image : images_) {
-    	if (image) {
-      	SDL_DestroyTexture(image);
-        }
-    }
-
-    // Clear the collection of images to ensure
+    // Clearing the collection of images ensures
     // idempotence
 
-    images_.clear();
+    layers_.reset();
+    if (assets_) {
+	assets_->clear();
+    }
 
     // Destroy the renderer and window, and set the
     // variables to nullptr to ensure idempotence
@@ -79,8 +115,15 @@ void GameDisplay::close() noexcept {
     	window_ = nullptr;
     }
 
+    // Stop the simulation, then finish the recording, if the game
+    // is being recorded
+    sim_.stop();
+    recorder_.close(session_.getTick());
+    session_.setRecorder(nullptr);
+
     // The last step is to quit SDL
     wasClosed_ = true;
+    IMG_Quit();
     SDL_Quit();
 }
 
@@ -89,304 +132,451 @@ bool GameDisplay::wasClosed() const noexcept {
 }
 
 void GameDisplay::startNextWave() noexcept {
-    // begin a new wave and release one projectile
-    Wave* nextWave = new Wave();
-    wave_ = *nextWave;
-    wave_.release();
+    sim_.startNextWave();
 }
 
-void GameDisplay::addImage(const string& fileLocation) noexcept {
-    if (renderer_) {
-
-    // Load the image from the file
-
-    SDL_Surface* imageSurface = IMG_Load(fileLocation.c_str());
-    if (imageSurface) {
-
-        // Convert the image to a texture
-
-      	SDL_Texture* imageTexture = 
-	    SDL_CreateTextureFromSurface(renderer_, imageSurface);
-      	if (imageTexture) {
-
-	// Add the image to the collection
-
-        images_.push_back(imageTexture);
-        } 
-	else {
-            cerr << "Unable to load the image file at " << fileLocation
-             << " due to: " << SDL_GetError() << endl;
-        } 
+void GameDisplay::checkForKeyEvent() noexcept {
 
-        // The surface is not longer needed
+    // Remove all events from the queue
 
-        SDL_FreeSurface(imageSurface);
-    } 
-    else {
-     	 cerr << "Unable to load the image file at " << fileLocation
-           << " due to: " << SDL_GetError() << endl;
+    ProfileScope scope(&profiler_, FrameProfiler::Input);
+    SDL_Event event;
+    while (!wasClosed_ && SDL_PollEvent(&event) != 0) {
+	handleEvent(event);
     }
-  }
 }
 
-void GameDisplay::checkForKeyEvent() noexcept {
+void GameDisplay::waitForKeyEvent(int timeout) noexcept {
 
-    // Remove all events from the queue
+    // Sleep until an event arrives or the timeout runs out, then
+    // handle whatever else is queued
 
     SDL_Event event;
-    while (SDL_PollEvent(&event) != 0) {
-	// handle a quit event by closing window
-	if (event.type == SDL_QUIT) {
-	    close();
-	    break;
-	  }
-	/* allow all key events if player is alive
- 	 * left key: move player to the left
-	 * right key: move player to the right
-	 * up key: move player up
-	 * down key: move player down
-	 * e key: allow mouse movement
-	 * r key: restart the game
- 	 * x key: close the window
-  	 */
-	else if (event.type == SDL_KEYDOWN && !player_.hasDied(wave_)) {
-	    switch (event.key.keysym.sym) {
-		case SDLK_LEFT:
-		    player_.move("left");
-		    break;
-		case SDLK_RIGHT:
-		    player_.move("right");
-		    break;
-		case SDLK_UP:
-		    player_.move("up");
-		    break;
-		case SDLK_DOWN:
-		    player_.move("down");
-		    break;
-		case SDLK_e:
-		    allowMouseMovement_ = !allowMouseMovement_;
-		    break;
-		case SDLK_r:
-		    wave_.resetWaveCount();
-		    startNextWave();
-		    refresh();
-		    break;
-	 	case SDLK_x:
-		    close();
-		    break;
-		default: break;
-	    }
+    if (SDL_WaitEventTimeout(&event, timeout) != 0) {
+	{
+	    ProfileScope scope(&profiler_, FrameProfiler::Input);
+	    handleEvent(event);
 	}
-	// if the player has died, restrict key handling
-	// to game reset and closing the window
-	else if (event.type == SDL_KEYDOWN) {
-	    switch (event.key.keysym.sym) {
-		case SDLK_r:
-		    wave_.resetWaveCount();
-		    startNextWave();
-		    refresh();
-		    break;
-		case SDLK_x:
-		    close();
-		    break;
-		    default: break;
-	    }
+	checkForKeyEvent();
+    }
+}
+
+void GameDisplay::handleEvent(const SDL_Event& event) noexcept {
+    // handle a quit event by closing window
+    if (event.type == SDL_QUIT) {
+	close();
+    }
+    // the window needs drawing again
+    else if (event.type == SDL_WINDOWEVENT) {
+	if (event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+	    redraw_ = true;
 	}
-	
-	// allow the player to move by mouse
-	else if (event.type == SDL_MOUSEMOTION && allowMouseMovement_) {
-	    int x;
-	    int y;
-	    // obtain mouse coordinates
-	    SDL_GetMouseState(&x, &y);	  
-	    player_.move(x, y);
+    }
+    // the renderer lost what was drawn into the cached layers, so
+    // they need painting again
+    else if (event.type == SDL_RENDER_TARGETS_RESET) {
+	if (layers_) {
+	    layers_->invalidate(backgroundLayer_);
+	}
+	redraw_ = true;
+    }
+    // the renderer lost every texture, so the images have to be
+    // uploaded again before the layers are painted from them. An
+    // image that fails to come back is reported when it is drawn
+    else if (event.type == SDL_RENDER_DEVICE_RESET) {
+	if (layers_) {
+	    layers_->reset();
+	}
+	if (assets_ && renderer_) {
+	    assets_->reload(renderer_);
+	}
+	redraw_ = true;
+    }
+    /* the arrow keys are read from the keyboard state once per frame,
+     * so their events only mark when an input arrived
+     */
+    else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && !event.key.repeat &&
+	(event.key.keysym.sym == SDLK_LEFT || event.key.keysym.sym == SDLK_RIGHT ||
+	 event.key.keysym.sym == SDLK_UP || event.key.keysym.sym == SDLK_DOWN)) {
+	noteInput(event.key.timestamp);
+    }
+    // p key: show or hide the profiler overlay, whatever the state,
+    // so it can be read on the death and intermission screens too
+    else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p) {
+	profiler_.setHudVisible(!profiler_.isHudVisible());
+	redraw_ = true;
+    }
+    /* allow all key events if player is alive
+     * e key: allow mouse movement
+     * r key: restart the game
+     * x key: close the window
+     */
+    else if (event.type == SDL_KEYDOWN && 
+	sim_.latest().state != GameSession::State::Dead) {
+	switch (event.key.keysym.sym) {
+	    case SDLK_e:
+		allowMouseMovement_ = !allowMouseMovement_;
+		break;
+	    case SDLK_r:
+		// wait for the restart to show, so the loop wakes to it
+		sim_.restart();
+		sim_.flush();
+		break;
+	    case SDLK_x:
+		close();
+		break;
+	    default: break;
 	}
     }
+    // if the player has died, restrict key handling
+    // to game reset and closing the window
+    else if (event.type == SDL_KEYDOWN) {
+	switch (event.key.keysym.sym) {
+	    case SDLK_r:
+		// wait for the restart to show, so the loop wakes to it
+		sim_.restart();
+		sim_.flush();
+		break;
+	    case SDLK_x:
+		close();
+		break;
+	    default: break;
+	}
+    }
+    // allow the player to move by mouse
+    else if (event.type == SDL_MOUSEMOTION && allowMouseMovement_) {
+	int x;
+	int y;
+	// obtain mouse coordinates
+	SDL_GetMouseState(&x, &y);	  
+	sim_.movePlayerTo(x, y);
+    }
 }
 
-void GameDisplay::runGame() noexcept {
-    unsigned int oldTime = SDL_GetTicks();
-    unsigned int currentTime;
+void GameDisplay::sampleKeyboard() noexcept {
+    // hold the player's controls in whichever arrows are down right
+    // now, rather than stepping once per key event
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    unsigned directions = 0;
+    if (keys[SDL_SCANCODE_LEFT]) {
+	directions |= Player::Left;
+    }
+    if (keys[SDL_SCANCODE_RIGHT]) {
+	directions |= Player::Right;
+    }
+    if (keys[SDL_SCANCODE_UP]) {
+	directions |= Player::Up;
+    }
+    if (keys[SDL_SCANCODE_DOWN]) {
+	directions |= Player::Down;
+    }
+    if (directions != directions_) {
+	directions_ = directions;
+	sim_.steerPlayer(directions);
+    }
+}
 
-    /** Handle game start. Wait for player to begin game */	
-    while(wave_.getReleasedCount() == 0) {
-	    if (wasClosed_) {
-	        break;
-	    }
-	    checkForKeyEvent();
-	    refresh();
+const GameSnapshot& GameDisplay::takeSnapshot() noexcept {
+    if (sim_.update()) {
+	// the session keeps running totals, so nothing is lost to
+	// snapshots that were never picked up
+	const GameSnapshot& snapshot = sim_.latest();
+	typedef chrono::duration<double, milli> Millis;
+	profiler_.add(FrameProfiler::Simulation, chrono::duration_cast<chrono::steady_clock::duration>(
+	    Millis(snapshot.simulationMs - simulationMs_)));
+	profiler_.add(FrameProfiler::Collision, chrono::duration_cast<chrono::steady_clock::duration>(
+	    Millis(snapshot.collisionMs - collisionMs_)));
+	simulationMs_ = snapshot.simulationMs;
+	collisionMs_ = snapshot.collisionMs;
     }
+    return sim_.latest();
+}
 
-    /** 
-     * Handle a game in progress. Check for key events, refresh screen,
-     * progress game.
-     */
-    while(!(player_.hasDied(wave_)) && wave_.getReleasedCount() != 0) {
-	    if (wasClosed_) {
-	        break;
-	    }
-	    checkForKeyEvent();
-	    refresh();
-	    wave_.onTick();
-	
-	    int upTo = 0;
-	    int count = wave_.getWaiting().size();
-	    /** Fire off a projectile every .15 seconds */
-		while (upTo != count) {
-	        currentTime = SDL_GetTicks();
-			if (currentTime - oldTime >= 150) {
-				wave_.release();
-				oldTime = currentTime;
-				upTo++;
-			}
-			wave_.onTick();
-			refresh();
-			checkForKeyEvent();
-			// when player dies, stop game
-			if (player_.hasDied(wave_)) {
-				break;
-			}
-		}
+void GameDisplay::noteInput(unsigned timestamp) noexcept {
+    // only the oldest input not yet on screen is timed, and only
+    // while the game is moving, since nothing else would show it
+    GameSession::State state = sim_.latest().state;
+    if (inputPending_ || (state != GameSession::State::Playing &&
+	state != GameSession::State::Intermission)) {
+	return;
+    }
+
+    // SDL stamps events in milliseconds since it started, so back
+    // the event's age off the steady clock
+    Uint32 age = SDL_GetTicks() - timestamp;
+    inputTime_ = chrono::steady_clock::now() - chrono::milliseconds(age);
+    inputTick_ = sim_.latest().tick;
+    inputPending_ = true;
+}
+
+void GameDisplay::runGame() noexcept {
+    if (!sim_.start()) {
+	cerr << "Unable to start the simulation thread" << endl;
+	close();
+	return;
     }
 
-    /*
-     * Handle player being dead. Disable mouse movement and wait
-     * for player to restart or exit game
+    /**
+     * One pass per frame: pump events once, pass the controls on to
+     * the simulation, draw its latest snapshot. While nothing is moving
+     * on its own the loop sleeps on the event queue instead of spinning.
      */
-    while (player_.hasDied(wave_)) {
-		allowMouseMovement_ = false;
-		if (wasClosed_) {
-			break;
+    unsigned long long frame = 0;
+    unsigned long long allocatingFrames = 0;
+    while (!wasClosed_) {
+	unsigned long long allocations = allocationCount();
+	profiler_.beginFrame();
+
+	// the simulation only times its steps while the overlay or the
+	// CSV has a use for the times
+	if (profiler_.isEnabled() != simProfiling_) {
+	    simProfiling_ = profiler_.isEnabled();
+	    sim_.setProfiling(simProfiling_);
+	}
+	const GameSnapshot& snapshot = takeSnapshot();
+	switch (snapshot.state) {
+	    /** 
+	     * Waiting for the player to begin the game, or dead and
+	     * waiting for a restart. Only input can change anything.
+	     */
+	    case GameSession::State::Waiting:
+	    case GameSession::State::Dead:
+		if (snapshot.state == GameSession::State::Dead) {
+		    allowMouseMovement_ = false;
+		}
+		waitForKeyEvent(idleTimeout_);
+		break;
+
+	    /**
+	     * Between waves. The player gets 2.5 seconds to reposition,
+	     * so sleep until input arrives or the next wave is due,
+	     * unless the player is moving.
+	     */
+	    case GameSession::State::Intermission:
+		if (directions_ != 0) {
+		    checkForKeyEvent();
 		}
+		else {
+		    waitForKeyEvent(int(ceil(snapshot.intermissionRemaining)) + 1);
+		}
+		break;
+
+	    /** A wave is in progress, vsync paces the frames */
+	    case GameSession::State::Playing:
 		checkForKeyEvent();
-		refresh();
+		break;
 	}
-    oldTime = SDL_GetTicks();
-    /* 
-     * We are now inbetween waves. Give the player 2.5 seconds
-     * to reposition / get ready for the next wave.
-     */
-    if (wave_.getReleasedCount() == 0 && !player_.hasDied(wave_)) {
-		currentTime = SDL_GetTicks();
-		// Prevent a wave from spawning for 2.5 seconds
-		while (currentTime - oldTime <= 2500) {
-			currentTime = SDL_GetTicks();
-			checkForKeyEvent();
-			refresh();
-		}
-		oldTime = currentTime;
-		startNextWave();
+	if (wasClosed_) {
+	    break;
+	}
+	{
+	    ProfileScope scope(&profiler_, FrameProfiler::Input);
+	    sampleKeyboard();
+	}
+	if (needsRedraw()) {
+	    refresh();
+	}
+	profiler_.endFrame();
+
+	// with allocations counted, prove the steady state allocates
+	// nothing by reporting any frame that did
+	if (countingAllocations()) {
+	    unsigned long long made = allocationCount() - allocations;
+	    if (made > 0) {
+		allocatingFrames++;
+		cerr << "frame " << frame << ": " << made << " heap allocations" << endl;
+	    }
+	}
+	frame++;
+    }
+    if (countingAllocations()) {
+	cerr << allocatingFrames << " of " << frame << " frames allocated" << endl;
     }
 }
 
+void GameDisplay::markStartup(const char* phase) {
+    auto now = chrono::steady_clock::now();
+    startupPhases_.emplace_back(phase,
+	chrono::duration<double, milli>(now - startupMark_).count());
+    startupMark_ = now;
+}
+
+bool GameDisplay::needsRedraw() noexcept {
+    const GameSnapshot& snapshot = takeSnapshot();
+    return redraw_ || profiler_.isHudVisible() ||
+	snapshot.state == GameSession::State::Playing ||
+	snapshot.state == GameSession::State::Intermission ||
+	snapshot.state != drawnState_ || snapshot.tick != drawnTick_;
+}
+
 void GameDisplay::refresh() {
     //cout << "Refreshing sprites..." << endl;
     if (renderer_) {
+	takeSnapshot();
+	{
+	    ProfileScope scope(&profiler_, FrameProfiler::Render);
+	    drawFrame();
+	}
+	{
+	    ProfileScope scope(&profiler_, FrameProfiler::Present);
+	    SDL_RenderPresent(renderer_);
+	}
+	redraw_ = false;
+	drawnTick_ = sim_.latest().tick;
+	drawnState_ = sim_.latest().state;
+
+	// the first frame ends the startup, so report how it went
+	if (timeToFirstFrame_ < 0.0) {
+	    markStartup("first frame");
+	    timeToFirstFrame_ = chrono::duration<double, milli>(
+		startupMark_ - startupBegin_).count();
+	    cerr << "startup:";
+	    for (const auto& phase : startupPhases_) {
+		cerr << ' ' << phase.first << ' ' << phase.second << " ms,";
+	    }
+	    cerr << " " << timeToFirstFrame_ << " ms to the first frame" << endl;
+	}
 
-    // Clear the window
-    
-    clearBackground();
-
-    // The location of the sprite is a square
-
-    SDL_Rect destination = { 0, 0, width_, height_ };
-
-    // Get the image index and check that it is valid
-
-    unsigned int imageIndex = 0;
-    if (imageIndex >= 0 && imageIndex < images_.size()) {
-	    // Get the image for the sprite
-            SDL_Texture* imageTexture = images_.at(imageIndex);
-            if (imageTexture) {
-
-	    // Render the image at the location,
-	    // rotated by its angle
+	// an input is on screen once a frame shows a step run since it
+	// arrived; one that arrived as the game stopped never will be
+	const GameSnapshot& snapshot = sim_.latest();
+	if (inputPending_ && snapshot.tick > inputTick_) {
+	    profiler_.addLatency(chrono::steady_clock::now() - inputTime_);
+	    inputPending_ = false;
+	}
+	else if (snapshot.state == GameSession::State::Dead ||
+	    snapshot.state == GameSession::State::Waiting) {
+	    inputPending_ = false;
+	}
+    }
+}
 
-                if (SDL_RenderCopyEx(renderer_, imageTexture, nullptr,
-                               &destination, 0, 
-                               nullptr, SDL_FLIP_NONE) != 0) {
-            	    close();
-            	    throw domain_error(string("Unable to render a sprite due to: ")
-                               + SDL_GetError());
-	    	}
-	    } 
-	    else {
-	    	close();
-            	throw domain_error("Missing image texture at index ");          
-            }
-    } 
-    else {
+void GameDisplay::drawFrame() {
+    // Resolve the images once, rather than for every sprite, and lay
+    // down the static layers. They cover the whole window, so there
+    // is no need to clear it first.
+    // get() throws if an image failed to load
+
+    const Sprite* playerSprite;
+    int layers;
+    try {
+	playerSprite = &assets_->get(playerImage_);
+	projectileSprites_.clear();
+	for (int image : projectileImages_) {
+	    projectileSprites_.push_back(&assets_->get(image));
+	}
+	layers = layers_->draw();
+    }
+    catch (const domain_error&) {
 	close();
-        throw domain_error("Invalid image index " );
+	throw;
+    }
+    if (layers != 0) {
+	close();
+	throw domain_error(string("Unable to draw the static layers due to: ")
+			   + SDL_GetError());
     }
-	
-    // Draw all of the sprites
 
-    for (const auto& proj : wave_.getReleased()) {
+    // The sprites all come from the atlas
 
-        // The location of the sprite is a square
+    SDL_FRect playerSource = { playerSprite->u, playerSprite->v,
+			       playerSprite->du, playerSprite->dv };
 
-        SDL_Rect destination = { proj.getX(), proj.getY(), 
-                               proj.getDiameter(), proj.getDiameter() };
+    // Queue all of the sprites into buffers from the frame arena
 
-        // Get the image index and check that it is valid
-        if (imageIndex >= 0 && imageIndex < images_.size()) {
+    // Draw between the snapshot's last two simulation steps, as far
+    // along as the simulation has got by now
 
-	    // Get the image for the sprite
-            SDL_Texture* imageTexture = images_.at(2);
-            if (imageTexture) {
+    const GameSnapshot& snapshot = sim_.latest();
+    double since = chrono::duration<double>(chrono::steady_clock::now() - snapshot.captured).count();
+    double alpha = min(1.0, snapshot.alpha + since / sim_.stepSeconds());
 
-	  	// Render the image at the location,
-	  	// rotated by its angle
+    frameArena_.reset();
+    batch_->begin(frameArena_, snapshot.size() + 1);
+    for (int ii = 0; ii < snapshot.size(); ii++) {
 
-          	if (SDL_RenderCopyEx(renderer_, imageTexture, nullptr,
-                               &destination, 0, 
-                               nullptr, SDL_FLIP_NONE) != 0) {
-            	    close();
-            	    throw domain_error(string("Unable to render a sprite due to: ")
-                               + SDL_GetError());
-          	}
-	    } 
-	    else {
-	  	close();
-          	throw domain_error("Missing image texture at index ");          
-            }
-	} 
-	else {
-	    close();
-            throw domain_error("Invalid image index " );
-        }
+        // The location of the sprite is a square around the
+        // projectile's center
+
+	double radius = projectileRadii_[snapshot.type[ii]];
+	double x = snapshot.prevx[ii] + (snapshot.posx[ii] - snapshot.prevx[ii]) * alpha;
+	double y = snapshot.prevy[ii] + (snapshot.posy[ii] - snapshot.prevy[ii]) * alpha;
+	int diameter = int(2.0 * radius + 0.5);
+        SDL_Rect destination = { int(x - radius + 0.5), int(y - radius + 0.5), 
+                               diameter, diameter };
+	const Sprite* sprite = projectileSprites_[snapshot.type[ii]];
+	SDL_FRect source = { sprite->u, sprite->v, sprite->du, sprite->dv };
+	batch_->add(sprite->texture, destination, source);
     }
 	
-    // The location of the sprite is a square
+    // The location of the sprite is a square, drawn at the same point
+    // between steps as the projectiles
 
-    SDL_Rect destinationP = { player_.getX(), player_.getY(), 
-                               player_.getDiameter(), player_.getDiameter() };
+    double playerX = snapshot.prevPlayerX + (snapshot.playerX - snapshot.prevPlayerX) * alpha;
+    double playerY = snapshot.prevPlayerY + (snapshot.playerY - snapshot.prevPlayerY) * alpha;
+    SDL_Rect destinationP = { int(floor(playerX + 0.5)), int(floor(playerY + 0.5)),
+                               snapshot.playerDiameter, snapshot.playerDiameter };
+    batch_->add(playerSprite->texture, destinationP, playerSource);
 
+    // Draw every queued sprite, one submission per texture
 
-    // Get the image for the sprite
+    if (batch_->draw(renderer_) != 0) {
+	close();
+        throw domain_error(string("Unable to render a sprite due to: ")
+                               + SDL_GetError());
+    }
 
-    SDL_Texture* imageTextureP = images_.at(1);
-    if (imageTextureP) {
+    if (profiler_.isHudVisible()) {
+	drawProfilerOverlay();
+    }
+}
 
-	// Render the image at the location,
-	// rotated by its angle
+void GameDisplay::drawProfilerOverlay() {
+    // One row per phase and a last one for input latency: p50, p99 and
+    // max bars stacked, at 20 pixels per millisecond, with a tick
+    // marking a 60 Hz frame budget
+
+    const int left = 10;
+    const int top = 10;
+    const int barHeight = 4;
+    const int rowHeight = 3 * barHeight + 4;
+    const double pixelsPerMs = 20.0;
+    const int maxWidth = width_ - 2 * left;
+    int rows = FrameProfiler::PhaseCount + 1;
+
+    SDL_Rect panel = { left - 4, top - 4, maxWidth + 8, rows * rowHeight + 8 };
+    SDL_Rect budget = { left + int(1000.0 / 60.0 * pixelsPerMs), top - 4, 1, rows * rowHeight + 8 };
+    SDL_Rect bars[3 * (FrameProfiler::PhaseCount + 1)];
+    for (int phase = 0; phase < rows; phase++) {
+	FrameProfiler::Stats stats = phase < FrameProfiler::PhaseCount
+	    ? profiler_.getStats(FrameProfiler::Phase(phase)) : profiler_.getLatencyStats();
+	double values[] = { stats.p50, stats.p99, stats.max };
+	for (int bar = 0; bar < 3; bar++) {
+	    int width = min(maxWidth, max(1, int(values[bar] * pixelsPerMs + 0.5)));
+	    bars[bar * rows + phase] = SDL_Rect{ left, top + phase * rowHeight + bar * barHeight,
+					       width, barHeight - 1 };
+	}
+    }
 
-        if (SDL_RenderCopyEx(renderer_, imageTextureP, nullptr,
-                               &destinationP, 0, 
-                               nullptr, SDL_FLIP_NONE) != 0) {
-	    close();
-            throw domain_error(string("Unable to render a sprite due to: ")
-                               + SDL_GetError());
-        }
-    } 
-    else {
+    // p50 in green, p99 in yellow, max in red
+    const Uint8 colors[3][3] = { { 0x40, 0xd0, 0x40 }, { 0xe0, 0xd0, 0x30 }, { 0xe0, 0x40, 0x40 } };
+    if (SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND) != 0 ||
+	SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0xa0) != 0 ||
+	SDL_RenderFillRect(renderer_, &panel) != 0 ||
+	SDL_SetRenderDrawColor(renderer_, 0xff, 0xff, 0xff, 0xff) != 0 ||
+	SDL_RenderFillRect(renderer_, &budget) != 0) {
 	close();
-        throw domain_error("Missing image texture at index ");          
+	throw domain_error(string("Unable to draw the profiler overlay due to: ")
+			   + SDL_GetError());
+    }
+    for (int bar = 0; bar < 3; bar++) {
+	if (SDL_SetRenderDrawColor(renderer_, colors[bar][0], colors[bar][1], colors[bar][2], 0xff) != 0 ||
+	    SDL_RenderFillRects(renderer_, bars + bar * rows, rows) != 0) {
+	    close();
+	    throw domain_error(string("Unable to draw the profiler overlay due to: ")
+			       + SDL_GetError());
+	}
     }
-	
-    SDL_RenderPresent(renderer_);
-  }
 }
 
 void GameDisplay::clearBackground() {
@@ -408,5 +598,23 @@ void GameDisplay::clearBackground() {
 }
 
 int GameDisplay::getWaveCount() const noexcept {
-    return wave_.getWave();
+    return sim_.latest().wave;
+}
+
+FrameProfiler& GameDisplay::getProfiler() noexcept {
+    return profiler_;
+}
+
+double GameDisplay::getTimeToFirstFrame() const noexcept {
+    return timeToFirstFrame_;
+}
+
+GameSession& GameDisplay::getSession() noexcept {
+    return session_;
+}
+
+bool GameDisplay::record(const string& path) {
+    bool opened = recorder_.open(path, session_.getSeed(), session_.getTickRate());
+    session_.setRecorder(opened ? &recorder_ : nullptr);
+    return opened;
 }
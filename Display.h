@@ -1,17 +1,28 @@
 #ifndef SPACEPIG_DISPLAY_H
 #define SPACEPIG_DISPLAY_H
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
-#include "Player.h"
-#include "Wave.h"
-#include "Projectile.h"
+#include "Arena.h"
+#include "FrameProfiler.h"
+#include "GameSession.h"
+#include "InputRecorder.h"
+#include "SessionThread.h"
 
 class SDL_Window;
 class SDL_Renderer;
-class SDL_Texture;
+union SDL_Event;
 
 namespace spacePig {
 
+class AssetManager;
+class LayerCache;
+struct Sprite;
+class SpriteBatch;
+
 /**
  * Extension of Kenneth Baclawski's SDL display.
  * Encapsulates SDL functionality into one single class.
@@ -58,14 +69,20 @@ public:
     void checkForKeyEvent() noexcept;
 
     /**
-     * plays through the game. Responsible for moving projectiles,
-     * checking for player movement, changes in the game state... 
-     * The hub for activity.
+     * plays through the game until the window is closed. The session
+     * runs on a simulation thread of its own, so the vsync wait in
+     * presenting never holds up the game. This thread handles input,
+     * passing it on as commands, and draws the latest snapshot the
+     * simulation has published, sleeping on the event queue whenever
+     * nothing is moving. In builds that count heap allocations, reports
+     * every frame that made any.
      */	
     void runGame() noexcept;
 
     /**
-     * Refresh the display.
+     * Refresh the display with the latest snapshot of the game. While
+     * the game is not running, the snapshot is taken from the session
+     * right away.
      * @throw domain_error if the display could not
      * be refreshed.
      */
@@ -76,6 +93,33 @@ public:
      * @return the wave number
      */
     int getWaveCount() const noexcept;
+
+    /**
+     * The per-phase frame profiler, for example to turn on CSV output.
+     * @return the profiler
+     */
+    FrameProfiler& getProfiler() noexcept;
+
+    /**
+     * How long the display took from construction to presenting its
+     * first frame.
+     * @return the time in milliseconds, or -1 if no frame was presented yet
+     */
+    double getTimeToFirstFrame() const noexcept;
+
+    /**
+     * The game being displayed. It belongs to the simulation thread
+     * while runGame() runs, so only use it before or after.
+     * @return the session
+     */
+    GameSession& getSession() noexcept;
+
+    /**
+     * Record the seed and every command of the game to a file, so
+     * that it can be replayed headless with SpacePigHeadless --replay.
+     * @return true if the file could be opened
+     */
+    bool record(/** path of the recording */ const std::string& path);
 private:
     /** The display window. */
     SDL_Window* window_ = nullptr;
@@ -83,8 +127,47 @@ private:
     /** The display rendering tool. */
     SDL_Renderer* renderer_ = nullptr;
 
-    /** The collection of images. */
-    std::vector<SDL_Texture*> images_;
+    /** Sprites queued for the frame being drawn. */
+    std::unique_ptr<SpriteBatch> batch_;
+
+    /** Transient storage for the frame being drawn, reset every frame. */
+    Arena frameArena_;
+
+    /** Every image the display draws, keyed by file location. */
+    std::unique_ptr<AssetManager> assets_;
+
+    /** The static layers, cached so they are not drawn every frame. */
+    std::unique_ptr<LayerCache> layers_;
+
+    /** The handle of the background's layer */
+    int backgroundLayer_ = 0;
+
+    /** Whether the window must be drawn again even if the game has not changed. */
+    bool redraw_ = true;
+
+    /** The step count of the snapshot last drawn. */
+    unsigned long long drawnTick_ = 0;
+
+    /** The state of the snapshot last drawn. */
+    GameSession::State drawnState_ = GameSession::State::Waiting;
+
+    /** Handle of the background image. */
+    int backgroundImage_ = -1;
+
+    /** Handle of the player's image. */
+    int playerImage_ = -1;
+
+    /**
+     * Handle of each projectile type's image, by type id. Types
+     * must be registered before the display is created.
+     */
+    std::vector<int> projectileImages_;
+
+    /** Each projectile type's image, resolved for the frame being drawn. */
+    std::vector<const Sprite*> projectileSprites_;
+
+    /** Each projectile type's radius, by type id. */
+    std::vector<double> projectileRadii_;
 
     /** The width of the window. */
     const int width_ = 0;
@@ -98,20 +181,109 @@ private:
     /** Whether or not the player can move using the mouse */
     bool allowMouseMovement_ = false;
 
-    /** The wave the player is on */
-    Wave wave_;
+    /** The game being displayed */
+    GameSession session_;
+
+    /** Runs the session and publishes snapshots of it to draw */
+    SessionThread sim_;
+
+    /** The directions last sent to the session */
+    unsigned directions_ = 0;
+
+    /** Whether the simulation thread has been asked to time its steps */
+    bool simProfiling_ = false;
+
+    /** The session's simulation time, in milliseconds, as of the last snapshot */
+    double simulationMs_ = 0.0;
+
+    /** The session's collision time, in milliseconds, as of the last snapshot */
+    double collisionMs_ = 0.0;
 
     /** The wave number the player is on */
     int waveCount_ = 0; 
 
-    /** The player for the game */
-    Player player_;
+    /** Times each phase of a frame */
+    FrameProfiler profiler_;
+
+    /** Writes the game to a file for replay */
+    InputRecorder recorder_;
+
+    /** Whether an input has arrived that is not on screen yet */
+    bool inputPending_ = false;
+
+    /** When that input arrived */
+    std::chrono::steady_clock::time_point inputTime_;
+
+    /** The session's step count when that input arrived */
+    unsigned long long inputTick_ = 0;
+
+    /** Longest the loop sleeps while waiting for input, in milliseconds */
+    int idleTimeout_ = 500;
+
+    /** When construction began, for timing the startup */
+    std::chrono::steady_clock::time_point startupBegin_;
+
+    /** When the last startup phase ended */
+    std::chrono::steady_clock::time_point startupMark_;
+
+    /** Each startup phase and its length in milliseconds, reported with the first frame */
+    std::vector<std::pair<const char*, double>> startupPhases_;
+
+    /** Milliseconds from construction to the first frame, or -1 until then */
+    double timeToFirstFrame_ = -1.0;
+
+    /**
+     * Block until an event arrives or a timeout runs out, then handle
+     * every queued event.
+     */
+    void waitForKeyEvent(/** milliseconds to wait at most */ int timeout) noexcept;
+
+    /**
+     * Steer the player by the arrow keys held down right now.
+     */
+    void sampleKeyboard() noexcept;
+
+    /**
+     * Pick up the latest snapshot of the game, and count the time the
+     * session spent simulating since the last one against this frame.
+     * @return the snapshot
+     */
+    const GameSnapshot& takeSnapshot() noexcept;
+
+    /**
+     * Start timing an input's latency, unless one is already being timed.
+     */
+    void noteInput(/** SDL timestamp of the input event */ unsigned timestamp) noexcept;
+
+    /**
+     * Handle one user event.
+     */
+    void handleEvent(/** the event */ const SDL_Event& event) noexcept;
+
+    /**
+     * Whether the latest snapshot differs from what is on screen.
+     * While the game is moving every frame is drawn; while it waits,
+     * the window is only drawn again when something changed.
+     * @return true if the window should be refreshed
+     */
+    bool needsRedraw() noexcept;
+
+    /**
+     * End a phase of the startup, timing it from the end of the last.
+     */
+    void markStartup(/** name of the phase */ const char* phase);
+
+    /**
+     * Draw the static layers, the sprites and any overlay into the
+     * back buffer, ready to be presented.
+     * @throw domain_error if the frame could not be drawn.
+     */
+    void drawFrame();
 
     /**
-     * Add an image to the collection.
+     * Draw the profiler's rolling p50, p99 and max bars for each phase.
      */
-    void addImage(/** The location of the file. */
-		const std::string& fileLocation) noexcept;
+    void drawProfilerOverlay();
 
     /**
      * Clear the background to opaque white.
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include "FrameProfiler.h"
+
+using namespace std;
+using namespace spacePig;
+
+FrameProfiler::FrameProfiler(int window) :
+    window_(window),
+    latencies_(window, 0.0),
+    sorted_(window, 0.0) {
+    for (int phase = 0; phase < PhaseCount; phase++) {
+	current_[phase] = 0.0;
+	total_[phase] = 0.0;
+	history_[phase].assign(window_, 0.0);
+    }
+}
+
+const char* FrameProfiler::phaseName(int phase) noexcept {
+    static const char* names[] = { "input", "simulation", "collision",
+	"render", "present", "frame" };
+    return phase >= 0 && phase < PhaseCount ? names[phase] : "unknown";
+}
+
+bool FrameProfiler::isHudVisible() const noexcept {
+    return hudVisible_;
+}
+
+void FrameProfiler::setHudVisible(bool visible) noexcept {
+    hudVisible_ = visible;
+    updateEnabled();
+}
+
+void FrameProfiler::setKeepTotals(bool keep) noexcept {
+    keepTotals_ = keep;
+    updateEnabled();
+}
+
+bool FrameProfiler::openCsv(const string& path) {
+    csv_.close();
+    csv_.clear();
+    csv_.open(path);
+    if (csv_) {
+	csv_ << "frame";
+	for (int phase = 0; phase < PhaseCount; phase++) {
+	    csv_ << ',' << phaseName(phase) << "_ms";
+	}
+	csv_ << ",input_latency_ms\n";
+    }
+    updateEnabled();
+    return bool(csv_);
+}
+
+void FrameProfiler::closeCsv() {
+    csv_.close();
+    updateEnabled();
+}
+
+void FrameProfiler::beginFrame() noexcept {
+    if (!enabled_) {
+	return;
+    }
+    for (int phase = 0; phase < PhaseCount; phase++) {
+	current_[phase] = 0.0;
+    }
+    frameStart_ = chrono::steady_clock::now();
+    frameOpen_ = true;
+}
+
+void FrameProfiler::endFrame() {
+    if (!frameOpen_) {
+	return;
+    }
+    frameOpen_ = false;
+    add(Frame, chrono::steady_clock::now() - frameStart_);
+
+    for (int phase = 0; phase < PhaseCount; phase++) {
+	history_[phase][next_] = current_[phase];
+    }
+    next_ = (next_ + 1) % window_;
+    recorded_ = min(recorded_ + 1, window_);
+
+    if (csv_.is_open()) {
+	csv_ << frame_;
+	for (int phase = 0; phase < PhaseCount; phase++) {
+	    csv_ << ',' << current_[phase];
+	}
+	// frames without a new input leave the latency blank
+	csv_ << ',';
+	if (currentLatency_ >= 0.0) {
+	    csv_ << currentLatency_;
+	}
+	csv_ << '\n';
+    }
+    currentLatency_ = -1.0;
+    frame_++;
+}
+
+void FrameProfiler::add(Phase phase, chrono::steady_clock::duration elapsed) noexcept {
+    double ms = chrono::duration<double, milli>(elapsed).count();
+    current_[phase] += ms;
+    total_[phase] += ms;
+}
+
+void FrameProfiler::addLatency(chrono::steady_clock::duration latency) noexcept {
+    if (!enabled_) {
+	return;
+    }
+    currentLatency_ = chrono::duration<double, milli>(latency).count();
+    latencies_[nextLatency_] = currentLatency_;
+    nextLatency_ = (nextLatency_ + 1) % window_;
+    recordedLatencies_ = min(recordedLatencies_ + 1, window_);
+}
+
+FrameProfiler::Stats FrameProfiler::getStats(Phase phase) const {
+    return summarize(history_[phase], recorded_);
+}
+
+double FrameProfiler::getTotal(Phase phase) const noexcept {
+    return total_[phase];
+}
+
+FrameProfiler::Stats FrameProfiler::getLatencyStats() const {
+    return summarize(latencies_, recordedLatencies_);
+}
+
+FrameProfiler::Stats FrameProfiler::summarize(const vector<double>& ring, int recorded) const {
+    Stats stats;
+    if (recorded == 0) {
+	return stats;
+    }
+
+    // the ring is only in order by age, so sort a copy, kept in
+    // scratch space so drawing the overlay does not allocate
+    copy_n(ring.begin(), recorded, sorted_.begin());
+    sort(sorted_.begin(), sorted_.begin() + recorded);
+    stats.p50 = sorted_[(recorded - 1) / 2];
+    stats.p99 = sorted_[(recorded - 1) * 99 / 100];
+    stats.max = sorted_[recorded - 1];
+    return stats;
+}
+
+void FrameProfiler::updateEnabled() noexcept {
+    enabled_ = hudVisible_ || keepTotals_ || csv_.is_open();
+}
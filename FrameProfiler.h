@@ -0,0 +1,242 @@
+#ifndef SPACEPIG_FRAMEPROFILER_H
+#define SPACEPIG_FRAMEPROFILER_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace spacePig {
+
+/**
+ * Times the phases of each frame: input, simulation, collision,
+ * rendering and presenting. Keeps the last few hundred frames of each
+ * phase so the median, 99th percentile and worst case can be shown,
+ * and optionally writes one CSV row per frame. It also keeps the
+ * latency from each input to the first frame presented with it.
+ *
+ * The profiler is off unless the overlay is visible or a CSV file is
+ * open. While it is off, a ProfileScope costs a single branch.
+ */
+class FrameProfiler {
+public:
+    /**
+     * The parts of a frame that are timed.
+     */
+    enum Phase {
+	/** pumping and handling events */
+	Input,
+	/** moving projectiles and releasing new ones */
+	Simulation,
+	/** checking the player against the projectiles */
+	Collision,
+	/** drawing the frame */
+	Render,
+	/** handing the frame to the display, including the vsync wait */
+	Present,
+	/** the whole frame */
+	Frame,
+	/** number of phases */
+	PhaseCount
+    };
+
+    /**
+     * Rolling statistics for one phase, in milliseconds.
+     */
+    struct Stats {
+	/** median */
+	double p50 = 0.0;
+
+	/** 99th percentile */
+	double p99 = 0.0;
+
+	/** worst case */
+	double max = 0.0;
+    };
+
+    /**
+     * Construct a profiler that is switched off.
+     */
+    FrameProfiler(/** number of recent frames kept per phase */ int window = 512);
+
+    /**
+     * The name of a phase, as used in the CSV header.
+     * @return the phase name
+     */
+    static const char* phaseName(/** the phase */ int phase) noexcept;
+
+    /**
+     * Whether or not timings are being taken.
+     * Inline so a disabled scope stays a single branch.
+     * @return true if the profiler is on
+     */
+    bool isEnabled() const noexcept { return enabled_; }
+
+    /**
+     * Whether or not the overlay should be drawn.
+     * @return true if the overlay is visible
+     */
+    bool isHudVisible() const noexcept;
+
+    /**
+     * Show or hide the overlay.
+     */
+    void setHudVisible(/** whether to show the overlay */ bool visible) noexcept;
+
+    /**
+     * Take timings even while there is no overlay or CSV file to show
+     * them, for a profiler whose running totals are read instead.
+     */
+    void setKeepTotals(/** whether to keep timing */ bool keep) noexcept;
+
+    /**
+     * Start writing one CSV row per frame to a file.
+     * @return true if the file could be opened
+     */
+    bool openCsv(/** path of the CSV file */ const std::string& path);
+
+    /**
+     * Stop writing CSV rows.
+     */
+    void closeCsv();
+
+    /**
+     * Mark the start of a frame.
+     */
+    void beginFrame() noexcept;
+
+    /**
+     * Mark the end of a frame, record its timings and write its row.
+     */
+    void endFrame();
+
+    /**
+     * Add time spent in a phase to the current frame.
+     */
+    void add(/** the phase */ Phase phase,
+	    /** time spent */ std::chrono::steady_clock::duration elapsed) noexcept;
+
+    /**
+     * Record the time from an input to the end of presenting the first
+     * frame that shows its effect, against the current frame.
+     */
+    void addLatency(/** input to photon time */ std::chrono::steady_clock::duration latency) noexcept;
+
+    /**
+     * Rolling statistics over the recent frames of a phase.
+     * @return the phase's statistics
+     */
+    Stats getStats(/** the phase */ Phase phase) const;
+
+    /**
+     * Time added to a phase since the profiler was constructed.
+     * @return the total in milliseconds
+     */
+    double getTotal(/** the phase */ Phase phase) const noexcept;
+
+    /**
+     * Rolling statistics over the recent input latencies.
+     * @return the latency statistics
+     */
+    Stats getLatencyStats() const;
+
+private:
+    /** number of recent frames kept per phase */
+    int window_ = 512;
+
+    /** whether timings are being taken */
+    bool enabled_ = false;
+
+    /** whether the overlay should be drawn */
+    bool hudVisible_ = false;
+
+    /** whether timings are taken for the totals alone */
+    bool keepTotals_ = false;
+
+    /** whether a frame has begun and not yet ended */
+    bool frameOpen_ = false;
+
+    /** when the current frame began */
+    std::chrono::steady_clock::time_point frameStart_;
+
+    /** time spent in each phase during the current frame, in milliseconds */
+    double current_[PhaseCount];
+
+    /** time spent in each phase in all, in milliseconds */
+    double total_[PhaseCount];
+
+    /** recent frame timings of each phase, in milliseconds, as rings */
+    std::vector<double> history_[PhaseCount];
+
+    /** slot of the next frame in the rings */
+    int next_ = 0;
+
+    /** number of frames recorded, up to the window */
+    int recorded_ = 0;
+
+    /** latency recorded against the current frame, negative for none */
+    double currentLatency_ = -1.0;
+
+    /** recent input latencies, in milliseconds, as a ring */
+    std::vector<double> latencies_;
+
+    /** slot of the next latency in the ring */
+    int nextLatency_ = 0;
+
+    /** number of latencies recorded, up to the window */
+    int recordedLatencies_ = 0;
+
+    /** number of frames recorded overall */
+    unsigned long long frame_ = 0;
+
+    /** the CSV file, when open */
+    std::ofstream csv_;
+
+    /** switch on while the overlay or the CSV file needs timings */
+    void updateEnabled() noexcept;
+
+    /** sorted copy of a ring, scratch space for the statistics */
+    mutable std::vector<double> sorted_;
+
+    /** statistics over the first recorded entries of a ring */
+    Stats summarize(const std::vector<double>& ring, int recorded) const;
+};
+
+/**
+ * Adds the time between its construction and destruction to a phase
+ * of the current frame. Does nothing if the profiler is missing or off.
+ */
+class ProfileScope {
+public:
+    ProfileScope(/** profiler to report to, may be null */ FrameProfiler* profiler,
+	    /** phase being timed */ FrameProfiler::Phase phase) noexcept :
+	profiler_(profiler && profiler->isEnabled() ? profiler : nullptr),
+	phase_(phase) {
+	if (profiler_) {
+	    start_ = std::chrono::steady_clock::now();
+	}
+    }
+
+    ~ProfileScope() {
+	if (profiler_) {
+	    profiler_->add(phase_, std::chrono::steady_clock::now() - start_);
+	}
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    /** profiler to report to, null when off */
+    FrameProfiler* profiler_;
+
+    /** phase being timed */
+    FrameProfiler::Phase phase_;
+
+    /** when the scope began */
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "GameSession.h"
+#include "InputRecorder.h"
+
+using namespace std;
+using namespace spacePig;
+
+GameSession::GameSession(Player player, double tickRate, unsigned seed,
+    const WaveParams& params) :
+    player_(player),
+    prevPlayerX_(player.getX()),
+    prevPlayerY_(player.getY()),
+    seed_(seed),
+    params_(params),
+    stepSeconds_(1.0 / tickRate)
+    {}
+
+GameSession::State GameSession::getState() const noexcept {
+    return state_;
+}
+
+const Wave& GameSession::getWave() const noexcept {
+    return wave_;
+}
+
+int GameSession::getPreviousPlayerX() const noexcept {
+    return prevPlayerX_;
+}
+
+int GameSession::getPreviousPlayerY() const noexcept {
+    return prevPlayerY_;
+}
+
+const Player& GameSession::getPlayer() const noexcept {
+    return player_;
+}
+
+unsigned long long GameSession::getTick() const noexcept {
+    return tick_;
+}
+
+double GameSession::getIntermissionRemaining() const noexcept {
+    return state_ == State::Intermission ? intermissionLength_ - sinceCleared_ : 0.0;
+}
+
+unsigned GameSession::getSeed() const noexcept {
+    return seed_;
+}
+
+double GameSession::getTickRate() const noexcept {
+    return 1.0 / stepSeconds_;
+}
+
+double GameSession::getGameSpeed() const noexcept {
+    return gameSpeed_;
+}
+
+void GameSession::restart() noexcept {
+    if (recorder_) {
+	recorder_->restart(tick_);
+    }
+    beginWave(1);
+}
+
+void GameSession::startNextWave() noexcept {
+    if (recorder_) {
+	recorder_->nextWave(tick_);
+    }
+    beginWave(wave_.getWave() + 1);
+}
+
+bool GameSession::beginWave(int number) noexcept {
+    // begin a new wave and release one projectile. A wave generated
+    // during the intermission is moved in, not copied, as long as it
+    // is still the one that comes next. Otherwise the wave is
+    // generated in the storage of one that is over, before the
+    // current wave is given up, so that running out of memory leaves
+    // the session as it was.
+    Wave ready = prefetcher_ ? prefetcher_->take() : Wave();
+    if (ready.getWave() != number) {
+	recycle(ready);
+	try {
+	    ready = Wave(number, seed_, params_, patternFor(number), std::move(spareArena_));
+	}
+	catch (const bad_alloc&) {
+	    return false;
+	}
+	catch (const length_error&) {
+	    return false;
+	}
+    }
+    recycle(wave_);
+    wave_ = std::move(ready);
+    wave_.release();
+    sinceRelease_ = 0.0;
+    state_ = State::Playing;
+    return true;
+}
+
+void GameSession::recycle(Wave& wave) noexcept {
+    unique_ptr<Arena> arena = wave.takeArena();
+    if (arena && !spareArena_) {
+	arena->reset();
+	spareArena_ = std::move(arena);
+    }
+}
+
+void GameSession::setWave(Wave wave) noexcept {
+    Wave ready = prefetcher_ ? prefetcher_->take() : Wave();
+    recycle(ready);
+    recycle(wave_);
+    wave_ = std::move(wave);
+    sinceRelease_ = 0.0;
+    state_ = State::Playing;
+}
+
+void GameSession::steerPlayer(unsigned directions) noexcept {
+    if (directions == directions_) {
+	return;
+    }
+    if (recorder_) {
+	recorder_->steer(tick_, directions);
+    }
+    directions_ = directions;
+}
+
+unsigned GameSession::getDirections() const noexcept {
+    return directions_;
+}
+
+void GameSession::movePlayerTo(int x, int y) noexcept {
+    if (recorder_) {
+	recorder_->moveTo(tick_, x, y);
+    }
+    if (state_ != State::Dead) {
+	player_.move(x, y);
+	// a jump is not drawn as a slide
+	prevPlayerX_ = player_.getX();
+	prevPlayerY_ = player_.getY();
+    }
+}
+
+void GameSession::step() noexcept {
+    tick_++;
+    double elapsed = stepSeconds_ * 1000.0;
+
+    // the held controls move the player by simulated time, so the
+    // pace does not depend on the frame rate or on key repeat. The
+    // collision test follows the player from where the step started.
+    Circle from = player_.getBody();
+    prevPlayerX_ = player_.getX();
+    prevPlayerY_ = player_.getY();
+    if (state_ != State::Dead && directions_ != 0) {
+	player_.move(directions_, stepSeconds_ * gameSpeed_);
+    }
+
+    switch (state_) {
+	case State::Playing: {
+	    {
+		ProfileScope scope(profiler_, FrameProfiler::Simulation);
+
+		// Fire off a projectile every releaseInterval_ milliseconds.
+		// Every release that has come due in this step goes out as
+		// one burst, so the interval may be shorter than a step.
+		sinceRelease_ += elapsed;
+		int due = int(sinceRelease_ / releaseInterval_);
+		if (due > 0) {
+		    wave_.release(due);
+		    sinceRelease_ -= due * releaseInterval_;
+		}
+		float radius = player_.getDiameter() / 2.0f;
+		wave_.setTarget(player_.getX() + radius, player_.getY() + radius);
+		wave_.onTick(stepSeconds_ * gameSpeed_);
+	    }
+
+	    bool died;
+	    {
+		ProfileScope scope(profiler_, FrameProfiler::Collision);
+		died = player_.hasDied(wave_, from);
+	    }
+
+	    if (died) {
+		state_ = State::Dead;
+	    }
+	    else if (wave_.isCleared()) {
+		// the wave is cleared, give the player time to reposition
+		// while the next wave is generated
+		sinceCleared_ = 0.0;
+		state_ = State::Intermission;
+		if (prefetcher_) {
+		    int next = wave_.getWave() + 1;
+		    prefetcher_->request(next, seed_, params_, patternFor(next),
+			std::move(spareArena_));
+		}
+	    }
+	    break;
+	}
+	case State::Intermission:
+	    sinceCleared_ += elapsed;
+	    if (sinceCleared_ > intermissionLength_ && !beginWave(wave_.getWave() + 1)) {
+		// try again after another intermission
+		sinceCleared_ = 0.0;
+	    }
+	    break;
+	default: break;
+    }
+
+    if (recorder_ && recorder_->wantsCheckpoint(tick_)) {
+	recorder_->checkpoint(tick_, getStateHash());
+    }
+}
+
+void GameSession::setProfiler(FrameProfiler* profiler) noexcept {
+    profiler_ = profiler;
+}
+
+void GameSession::setPrefetchWaves(bool prefetch) noexcept {
+    if (!prefetch) {
+	prefetcher_.reset();
+    }
+    else if (!prefetcher_) {
+	prefetcher_.reset(new WavePrefetcher());
+    }
+}
+
+void GameSession::setPatterns(vector<Pattern> patterns) {
+    patterns_ = std::move(patterns);
+}
+
+const Pattern* GameSession::patternFor(int wave) const noexcept {
+    if (patterns_.empty()) {
+	return nullptr;
+    }
+    return &patterns_[(wave - 1) % patterns_.size()];
+}
+
+void GameSession::setRecorder(InputRecorder* recorder) noexcept {
+    recorder_ = recorder;
+}
+
+namespace {
+
+/** fold raw bytes into a 64-bit FNV-1a hash */
+void fnv(unsigned long long& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t ii = 0; ii < size; ii++) {
+	hash = (hash ^ bytes[ii]) * 1099511628211ULL;
+    }
+}
+
+}
+
+unsigned long long GameSession::getStateHash() const noexcept {
+    unsigned long long hash = 14695981039346656037ULL;
+    int state = int(state_);
+    int wave = wave_.getWave();
+    int waiting = wave_.getWaitingCount();
+    int released = wave_.getReleasedCount();
+    int player[] = { player_.getX(), player_.getY() };
+    unsigned long long emitter = wave_.getEmitter().getStateHash();
+    fnv(hash, &tick_, sizeof(tick_));
+    fnv(hash, &state, sizeof(state));
+    fnv(hash, &wave, sizeof(wave));
+    fnv(hash, &waiting, sizeof(waiting));
+    fnv(hash, &released, sizeof(released));
+    fnv(hash, player, sizeof(player));
+    fnv(hash, &directions_, sizeof(directions_));
+    fnv(hash, &sinceRelease_, sizeof(sinceRelease_));
+    fnv(hash, &sinceCleared_, sizeof(sinceCleared_));
+    fnv(hash, &emitter, sizeof(emitter));
+
+    const ProjectilePool& pool = wave_.getReleased().pool();
+    fnv(hash, pool.posx(), released * sizeof(*pool.posx()));
+    fnv(hash, pool.posy(), released * sizeof(*pool.posy()));
+    fnv(hash, pool.vx(), released * sizeof(*pool.vx()));
+    fnv(hash, pool.vy(), released * sizeof(*pool.vy()));
+    fnv(hash, pool.type(), released * sizeof(*pool.type()));
+    return hash;
+}
@@ -0,0 +1,276 @@
+#ifndef SPACEPIG_GAMESESSION_H
+#define SPACEPIG_GAMESESSION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameProfiler.h"
+#include "Pattern.h"
+#include "Player.h"
+#include "Wave.h"
+#include "WavePrefetcher.h"
+
+namespace spacePig {
+
+class InputRecorder;
+
+/**
+ * The game without any display attached.
+ * A session owns the player and the current wave, and advances them
+ * one fixed simulation step at a time: releasing projectiles, moving
+ * them, checking for collisions and moving on to the next wave.
+ * Nothing here depends on SDL, so a session can be driven by the
+ * GameDisplay or run headless as fast as the CPU allows.
+ */
+class GameSession {
+public:
+    /**
+     * The phase of play the session is in.
+     */
+    enum class State {
+	/** no game started yet, waiting for a restart */
+	Waiting,
+	/** a wave is in progress */
+	Playing,
+	/** the player has been hit, waiting for a restart */
+	Dead,
+	/** a wave was cleared and the next one is about to start */
+	Intermission
+    };
+
+    /**
+     * Construct a session that has not started yet.
+     * Sessions built with the same seed and parameters generate the
+     * same waves.
+     */
+    GameSession(/** Player for game */ Player player = Player(),
+	    /** simulation steps per real second */ double tickRate = 60.0,
+	    /** seed for every wave of the game */ unsigned seed = 1,
+	    /** how to generate the waves */ const WaveParams& params = WaveParams());
+
+    /**
+     * The phase of play the session is in.
+     * @return the current state
+     */
+    State getState() const noexcept;
+
+    /**
+     * The wave being played.
+     * @return the current wave
+     */
+    const Wave& getWave() const noexcept;
+
+    /**
+     * The player of the game.
+     * @return the player
+     */
+    const Player& getPlayer() const noexcept;
+
+    /**
+     * The x-coordinate of the top left of the player when the last
+     * step began, so the player can be drawn between steps like the
+     * projectiles. Moving the player to a point moves it too.
+     * @return the x-coordinate
+     */
+    int getPreviousPlayerX() const noexcept;
+
+    /**
+     * The y-coordinate of the top left of the player when the last
+     * step began.
+     * @return the y-coordinate
+     */
+    int getPreviousPlayerY() const noexcept;
+
+    /**
+     * The number of simulation steps taken so far.
+     * @return the step count
+     */
+    unsigned long long getTick() const noexcept;
+
+    /**
+     * How long until the next wave starts, while in Intermission.
+     * @return the remaining time in milliseconds
+     */
+    double getIntermissionRemaining() const noexcept;
+
+    /**
+     * The seed the session's waves are generated from.
+     * @return the seed
+     */
+    unsigned getSeed() const noexcept;
+
+    /**
+     * The number of simulation steps per real second.
+     * @return the tick rate
+     */
+    double getTickRate() const noexcept;
+
+    /**
+     * The number of simulated seconds per real second.
+     * @return the game speed
+     */
+    double getGameSpeed() const noexcept;
+
+    /**
+     * Start over from the first wave. If there is not the memory for
+     * the wave, the session carries on as it was.
+     */
+    void restart() noexcept;
+
+    /**
+     * begin the next wave and release a projectile. If there is not
+     * the memory for the wave, the session carries on as it was.
+     */
+    void startNextWave() noexcept;
+
+    /**
+     * Play a prepared wave in place of the current one, for example to
+     * benchmark a frame with a known number of projectiles.
+     */
+    void setWave(/** wave to play */ Wave wave) noexcept;
+
+    /**
+     * Hold the player's controls in a set of directions. From the next
+     * step on, the player moves that way on every step, at the same
+     * pace whatever the frame rate, until the directions change.
+     * The player does not move once they have died.
+     */
+    void steerPlayer(/** Player::Direction flags, or 0 to stand still */ unsigned directions) noexcept;
+
+    /**
+     * The directions the player's controls are held in.
+     * @return the Player::Direction flags
+     */
+    unsigned getDirections() const noexcept;
+
+    /**
+     * Move the player to a point on the screen.
+     * Ignored once the player has died.
+     */
+    void movePlayerTo(/** x-coord destination */ int x,
+	    /** y-coord destination */ int y) noexcept;
+
+    /**
+     * Advance the game by one fixed simulation step.
+     */
+    void step() noexcept;
+
+    /**
+     * Report simulation and collision timings to a profiler.
+     */
+    void setProfiler(/** profiler to report to, or null for none */ FrameProfiler* profiler) noexcept;
+
+    /**
+     * Generate each next wave on a worker thread while the player is
+     * between waves, so that starting it costs no time on the frame.
+     * Off by default, which keeps the session single threaded.
+     */
+    void setPrefetchWaves(/** whether to generate waves ahead */ bool prefetch) noexcept;
+
+    /**
+     * Play bullet patterns on top of the random projectiles, one per
+     * wave in turn, starting over after the last. Set them before the
+     * game starts; recordings only replay with the same patterns.
+     */
+    void setPatterns(/** patterns to play, or none */ std::vector<Pattern> patterns);
+
+    /**
+     * Record every command given to the session, and checkpoints of
+     * its state, so the game can be replayed.
+     */
+    void setRecorder(/** recorder to write to, or null for none */ InputRecorder* recorder) noexcept;
+
+    /**
+     * A hash of everything that decides how the game plays out from
+     * here: the phase of play, the wave and its pattern emitter, the
+     * player and every projectile. Two sessions with the same hash will stay in step
+     * given the same commands.
+     * @return the state hash
+     */
+    unsigned long long getStateHash() const noexcept;
+
+private:
+    /** The phase of play */
+    State state_ = State::Waiting;
+
+    /** The wave the player is on */
+    Wave wave_;
+
+    /** The player for the game */
+    Player player_;
+
+    /** Top left of the player when the last step began */
+    int prevPlayerX_ = 0;
+    int prevPlayerY_ = 0;
+
+    /** Seed for every wave of the game */
+    unsigned seed_ = 1;
+
+    /** How to generate the waves */
+    WaveParams params_;
+
+    /** Bullet patterns played by the waves in turn */
+    std::vector<Pattern> patterns_;
+
+    /** Real seconds covered by one step */
+    double stepSeconds_ = 1.0 / 60.0;
+
+    /**
+     * Simulated seconds per real second. 0.6 matches the old pace
+     * of one 0.01 s tick per frame at 60 Hz.
+     */
+    double gameSpeed_ = 0.6;
+
+    /** Player::Direction flags the controls are held in */
+    unsigned directions_ = 0;
+
+    /** Milliseconds between projectile releases during a wave */
+    double releaseInterval_ = 150.0;
+
+    /** Milliseconds since the last release */
+    double sinceRelease_ = 0.0;
+
+    /** Milliseconds to wait between waves */
+    double intermissionLength_ = 2500.0;
+
+    /** Milliseconds spent in the current intermission */
+    double sinceCleared_ = 0.0;
+
+    /** Simulation steps taken so far */
+    unsigned long long tick_ = 0;
+
+    /** Profiler to report timings to, if any */
+    FrameProfiler* profiler_ = nullptr;
+
+    /** Recorder to write commands to, if any */
+    InputRecorder* recorder_ = nullptr;
+
+    /** Generates the next wave during the intermission, if enabled */
+    std::unique_ptr<WavePrefetcher> prefetcher_;
+
+    /** Storage of a finished wave, kept to generate a later wave in */
+    std::unique_ptr<Arena> spareArena_;
+
+    /**
+     * The pattern a wave plays.
+     * @return the pattern, or null if there are none
+     */
+    const Pattern* patternFor(/** the wave number */ int wave) const noexcept;
+
+    /**
+     * Generate a wave and release its first projectile, or keep the
+     * current wave if there is not the memory for the new one.
+     * @return false if the wave could not be generated
+     */
+    bool beginWave(/** the wave number */ int number) noexcept;
+
+    /**
+     * Keep a wave's arena as the spare, if there is no spare yet.
+     * Afterwards the wave may only be destroyed or replaced.
+     */
+    void recycle(/** a wave that is over */ Wave& wave) noexcept;
+};
+
+}
+
+#endif
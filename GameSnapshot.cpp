@@ -0,0 +1,32 @@
+#include "GameSnapshot.h"
+
+using namespace std;
+using namespace spacePig;
+
+void GameSnapshot::capture(const GameSession& session) {
+    tick = session.getTick();
+    state = session.getState();
+    wave = session.getWave().getWave();
+    intermissionRemaining = session.getIntermissionRemaining();
+
+    const Player& player = session.getPlayer();
+    playerX = player.getX();
+    playerY = player.getY();
+    prevPlayerX = session.getPreviousPlayerX();
+    prevPlayerY = session.getPreviousPlayerY();
+    playerDiameter = player.getDiameter();
+
+    // assign() reuses the vectors' storage once they are big enough
+    const ProjectilePool& pool = session.getWave().getReleased().pool();
+    int count = pool.size();
+    prevx.assign(pool.prevx(), pool.prevx() + count);
+    prevy.assign(pool.prevy(), pool.prevy() + count);
+    posx.assign(pool.posx(), pool.posx() + count);
+    posy.assign(pool.posy(), pool.posy() + count);
+    type.assign(pool.type(), pool.type() + count);
+    captured = chrono::steady_clock::now();
+}
+
+int GameSnapshot::size() const noexcept {
+    return int(posx.size());
+}
@@ -0,0 +1,88 @@
+#ifndef SPACEPIG_GAMESNAPSHOT_H
+#define SPACEPIG_GAMESNAPSHOT_H
+
+#include <chrono>
+#include <vector>
+#include "GameSession.h"
+
+namespace spacePig {
+
+/**
+ * Everything needed to draw one moment of a game, copied out of a
+ * GameSession so it can be read on another thread while the session
+ * moves on. A snapshot holds the projectiles' positions before and
+ * after the last step, so a frame can be drawn between the two.
+ *
+ * Capturing into a snapshot reuses its storage, so once a snapshot
+ * has held the largest wave of a game, capturing allocates nothing.
+ */
+struct GameSnapshot {
+    /** the session's step count */
+    unsigned long long tick = 0;
+
+    /** the session's state */
+    GameSession::State state = GameSession::State::Waiting;
+
+    /** the wave number */
+    int wave = 0;
+
+    /** milliseconds left between waves, 0 outside of an intermission */
+    double intermissionRemaining = 0.0;
+
+    /** x-coordinate of the top left of the player */
+    int playerX = 0;
+
+    /** y-coordinate of the top left of the player */
+    int playerY = 0;
+
+    /** x-coordinate of the top left of the player before the last step */
+    int prevPlayerX = 0;
+
+    /** y-coordinate of the top left of the player before the last step */
+    int prevPlayerY = 0;
+
+    /** the player's diameter */
+    int playerDiameter = 0;
+
+    /** projectile x-coordinates before the last step */
+    std::vector<float> prevx;
+
+    /** projectile y-coordinates before the last step */
+    std::vector<float> prevy;
+
+    /** projectile x-coordinates */
+    std::vector<float> posx;
+
+    /** projectile y-coordinates */
+    std::vector<float> posy;
+
+    /** projectile type ids */
+    std::vector<unsigned char> type;
+
+    /** when the snapshot was captured */
+    std::chrono::steady_clock::time_point captured;
+
+    /** how far towards the next step the session's clock was when captured */
+    double alpha = 0.0;
+
+    /** milliseconds the session has spent simulating while profiled, in all */
+    double simulationMs = 0.0;
+
+    /** milliseconds the session has spent checking collisions while profiled, in all */
+    double collisionMs = 0.0;
+
+    /**
+     * Copy the state of a session into the snapshot.
+     */
+    void capture(/** the session */ const GameSession& session);
+
+    /**
+     * The number of projectiles in the snapshot.
+     * @return the projectile count
+     */
+    int size() const noexcept;
+};
+
+}
+
+#endif
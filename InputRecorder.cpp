@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "GameSession.h"
+#include "InputRecorder.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+const char magic[4] = { 'S', 'P', 'I', 'R' };
+// version 2 generates projectiles from counter-based streams,
+// version 3 simulates them in single precision, version 4 records
+// held directions in place of single keyboard steps, and version 5
+// tests collisions along each step rather than at its end
+const unsigned char version = 5;
+
+void writeFixed(ostream& out, unsigned long long value, int bytes) {
+    for (int ii = 0; ii < bytes; ii++) {
+	out.put(char(value >> (8 * ii)));
+    }
+}
+
+void writeVarint(ostream& out, unsigned long long value) {
+    while (value >= 0x80) {
+	out.put(char(value | 0x80));
+	value >>= 7;
+    }
+    out.put(char(value));
+}
+
+/** fold the sign into the low bit so small negatives stay short */
+unsigned long long zigzag(long long value) {
+    return (unsigned long long)(value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+unsigned long long readFixed(istream& in, int bytes) {
+    unsigned long long value = 0;
+    for (int ii = 0; ii < bytes; ii++) {
+	int byte = in.get();
+	if (byte == EOF) {
+	    throw domain_error("Truncated recording");
+	}
+	value |= (unsigned long long)(byte) << (8 * ii);
+    }
+    return value;
+}
+
+unsigned long long readVarint(istream& in) {
+    unsigned long long value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+	int byte = in.get();
+	if (byte == EOF) {
+	    throw domain_error("Truncated recording");
+	}
+	value |= (unsigned long long)(byte & 0x7f) << shift;
+	if (!(byte & 0x80)) {
+	    return value;
+	}
+    }
+    throw domain_error("Corrupt recording");
+}
+
+long long unzigzag(unsigned long long value) {
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+}
+
+bool InputRecorder::open(const string& path, unsigned seed, double tickRate,
+    unsigned checkpointInterval) {
+    out_.close();
+    out_.clear();
+    out_.open(path, ios::binary | ios::trunc);
+    lastTick_ = 0;
+    checkpointInterval_ = checkpointInterval;
+    if (!out_) {
+	return false;
+    }
+
+    unsigned long long rate;
+    memcpy(&rate, &tickRate, sizeof(rate));
+    out_.write(magic, sizeof(magic));
+    out_.put(char(version));
+    writeFixed(out_, seed, 4);
+    writeFixed(out_, rate, 8);
+    writeFixed(out_, checkpointInterval_, 4);
+    return bool(out_);
+}
+
+void InputRecorder::close(unsigned long long tick) noexcept {
+    if (out_.is_open()) {
+	begin(End, tick);
+	out_.close();
+    }
+}
+
+bool InputRecorder::isOpen() const noexcept {
+    return out_.is_open();
+}
+
+void InputRecorder::restart(unsigned long long tick) noexcept {
+    if (out_.is_open()) {
+	begin(Restart, tick);
+    }
+}
+
+void InputRecorder::nextWave(unsigned long long tick) noexcept {
+    if (out_.is_open()) {
+	begin(NextWave, tick);
+    }
+}
+
+void InputRecorder::steer(unsigned long long tick, unsigned directions) noexcept {
+    if (out_.is_open()) {
+	begin(Steer, tick);
+	out_.put(char(directions));
+    }
+}
+
+void InputRecorder::moveTo(unsigned long long tick, int x, int y) noexcept {
+    if (out_.is_open()) {
+	begin(MoveTo, tick);
+	writeVarint(out_, zigzag(x));
+	writeVarint(out_, zigzag(y));
+    }
+}
+
+bool InputRecorder::wantsCheckpoint(unsigned long long tick) const noexcept {
+    return out_.is_open() && checkpointInterval_ != 0 && tick % checkpointInterval_ == 0;
+}
+
+void InputRecorder::checkpoint(unsigned long long tick, unsigned long long hash) noexcept {
+    if (out_.is_open()) {
+	begin(Checkpoint, tick);
+	writeFixed(out_, hash, 8);
+    }
+}
+
+void InputRecorder::begin(Op op, unsigned long long tick) {
+    out_.put(char(op));
+    writeVarint(out_, tick - lastTick_);
+    lastTick_ = tick;
+}
+
+ReplayResult spacePig::replayInputs(const string& path,
+    const vector<Pattern>& patterns) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+	throw domain_error("Unable to open recording " + path);
+    }
+
+    char header[sizeof(magic)];
+    if (!in.read(header, sizeof(header)) || memcmp(header, magic, sizeof(magic)) != 0
+	|| in.get() != version) {
+	throw domain_error(path + " is not a SpacePig recording");
+    }
+    unsigned seed = unsigned(readFixed(in, 4));
+    unsigned long long rate = readFixed(in, 8);
+    double tickRate;
+    memcpy(&tickRate, &rate, sizeof(tickRate));
+    readFixed(in, 4);
+
+    GameSession session(Player(), tickRate, seed);
+    session.setPatterns(patterns);
+    ReplayResult result;
+    unsigned long long tick = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (;;) {
+	int op = in.get();
+	if (op == EOF) {
+	    // the game ended without closing the recording, so
+	    // replay as far as it goes
+	    break;
+	}
+	tick += readVarint(in);
+	while (session.getTick() < tick) {
+	    session.step();
+	}
+
+	if (op == InputRecorder::End) {
+	    break;
+	}
+	if (op == InputRecorder::Checkpoint) {
+	    unsigned long long hash = readFixed(in, 8);
+	    if (hash != session.getStateHash() && result.mismatches++ == 0) {
+		result.firstMismatch = tick;
+	    }
+	    result.checkpoints++;
+	    continue;
+	}
+
+	switch (op) {
+	    case InputRecorder::Restart: session.restart(); break;
+	    case InputRecorder::NextWave: session.startNextWave(); break;
+	    case InputRecorder::Steer: session.steerPlayer(unsigned(readFixed(in, 1))); break;
+	    case InputRecorder::MoveTo: {
+		int x = int(unzigzag(readVarint(in)));
+		int y = int(unzigzag(readVarint(in)));
+		session.movePlayerTo(x, y);
+		break;
+	    }
+	    default:
+		throw domain_error("Corrupt recording " + path);
+	}
+	result.commands++;
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.ticks = session.getTick();
+    return result;
+}
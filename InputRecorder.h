@@ -0,0 +1,153 @@
+#ifndef SPACEPIG_INPUTRECORDER_H
+#define SPACEPIG_INPUTRECORDER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Pattern.h"
+
+namespace spacePig {
+
+/**
+ * Writes a game session to a compact binary file: the seed and tick
+ * rate the session was started with, then every command given to it,
+ * stamped with the simulation step it arrived before. Since waves
+ * are generated from the seed, replaying the commands at the same
+ * steps reproduces the game exactly.
+ *
+ * Every few hundred steps a hash of the session state is written as
+ * a checkpoint, so a replay can tell where it first went astray.
+ *
+ * The file starts with the bytes "SPIR", a version byte, the seed,
+ * the tick rate and the checkpoint interval. Each record that follows
+ * is an opcode byte, the steps since the previous record as a varint,
+ * and the opcode's operands. Multi-byte values are little endian.
+ */
+class InputRecorder {
+public:
+    /**
+     * Construct a recorder that is not writing anywhere.
+     */
+    InputRecorder() = default;
+
+    /**
+     * Start recording a session to a file, replacing any earlier recording.
+     * @return true if the file could be opened
+     */
+    bool open(/** path of the recording */ const std::string& path,
+	    /** seed the session generates its waves from */ unsigned seed,
+	    /** simulation steps per second */ double tickRate,
+	    /** steps between state checkpoints */ unsigned checkpointInterval = 600);
+
+    /**
+     * Mark the end of the session and close the file. Does nothing
+     * if no recording is open.
+     */
+    void close(/** steps taken by the session */ unsigned long long tick) noexcept;
+
+    /**
+     * Whether or not a recording is open.
+     * @return true if commands are being written
+     */
+    bool isOpen() const noexcept;
+
+    /**
+     * Record that the session was restarted.
+     */
+    void restart(/** steps taken by the session */ unsigned long long tick) noexcept;
+
+    /**
+     * Record that the next wave was started early.
+     */
+    void nextWave(/** steps taken by the session */ unsigned long long tick) noexcept;
+
+    /**
+     * Record a change in the directions the player's controls are held in.
+     */
+    void steer(/** steps taken by the session */ unsigned long long tick,
+	    /** Player::Direction flags */ unsigned directions) noexcept;
+
+    /**
+     * Record the player being moved to a point on the screen.
+     */
+    void moveTo(/** steps taken by the session */ unsigned long long tick,
+	    /** x-coord destination */ int x,
+	    /** y-coord destination */ int y) noexcept;
+
+    /**
+     * Whether or not the session should be checkpointed after a step.
+     * @return true if a checkpoint is due
+     */
+    bool wantsCheckpoint(/** steps taken by the session */ unsigned long long tick) const noexcept;
+
+    /**
+     * Record the state hash of the session.
+     */
+    void checkpoint(/** steps taken by the session */ unsigned long long tick,
+	    /** GameSession::getStateHash() after the step */ unsigned long long hash) noexcept;
+
+    /**
+     * Record opcodes.
+     */
+    enum Op : unsigned char {
+	End = 0,
+	Restart = 1,
+	NextWave = 2,
+	Steer = 3,
+	MoveTo = 4,
+	Checkpoint = 5
+    };
+
+private:
+    /** the recording */
+    std::ofstream out_;
+
+    /** step of the last record written */
+    unsigned long long lastTick_ = 0;
+
+    /** steps between state checkpoints, 0 for none */
+    unsigned checkpointInterval_ = 0;
+
+    /**
+     * Write the opcode and step stamp that start a record.
+     */
+    void begin(Op op, unsigned long long tick);
+};
+
+/**
+ * The outcome of replaying a recording.
+ */
+struct ReplayResult {
+    /** simulation steps replayed */
+    unsigned long long ticks = 0;
+
+    /** commands applied to the session */
+    unsigned long long commands = 0;
+
+    /** checkpoints compared */
+    int checkpoints = 0;
+
+    /** checkpoints whose hash differed from the recording */
+    int mismatches = 0;
+
+    /** step of the first differing checkpoint */
+    unsigned long long firstMismatch = 0;
+
+    /** wall-clock seconds the replay took */
+    double seconds = 0.0;
+};
+
+/**
+ * Re-run a recorded session as fast as possible, with no window,
+ * comparing the state hash at every checkpoint. A game played with
+ * bullet patterns must be replayed with the same patterns.
+ * @return what the replay found
+ * @throw domain_error if the file could not be read or is not a recording.
+ */
+ReplayResult replayInputs(/** path of the recording */ const std::string& path,
+	/** patterns the game was played with */
+	const std::vector<Pattern>& patterns = std::vector<Pattern>());
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "LayerCache.h"
+
+using namespace std;
+using namespace spacePig;
+
+LayerCache::LayerCache(SDL_Renderer* renderer, int width, int height) :
+    renderer_(renderer),
+    width_(width),
+    height_(height),
+    supported_(SDL_RenderTargetSupported(renderer) == SDL_TRUE)
+    {}
+
+LayerCache::~LayerCache() {
+    reset();
+}
+
+int LayerCache::addLayer(Painter painter) {
+    layers_.push_back(painter);
+    dirty_ = true;
+    return int(layers_.size()) - 1;
+}
+
+void LayerCache::invalidate(int) noexcept {
+    // the layers are flattened together, so any change repaints them all
+    dirty_ = true;
+}
+
+void LayerCache::reset() noexcept {
+    if (target_) {
+	SDL_DestroyTexture(target_);
+	target_ = nullptr;
+    }
+    dirty_ = true;
+}
+
+bool LayerCache::isCached() const noexcept {
+    return target_ != nullptr;
+}
+
+int LayerCache::draw() {
+    if (!supported_) {
+	return paint();
+    }
+
+    if (!target_) {
+	target_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+	    SDL_TEXTUREACCESS_TARGET, width_, height_);
+	if (!target_) {
+	    // no room for a target, so paint into every frame instead
+	    supported_ = false;
+	    return paint();
+	}
+
+	// the target is opaque throughout, so copying it needs no blending
+	if (SDL_SetTextureBlendMode(target_, SDL_BLENDMODE_NONE) != 0) {
+	    return -1;
+	}
+	dirty_ = true;
+    }
+
+    if (dirty_) {
+	if (SDL_SetRenderTarget(renderer_, target_) != 0) {
+	    return -1;
+	}
+	int status;
+	try {
+	    status = paint();
+	}
+	catch (...) {
+	    SDL_SetRenderTarget(renderer_, nullptr);
+	    throw;
+	}
+	if (SDL_SetRenderTarget(renderer_, nullptr) != 0 || status != 0) {
+	    return -1;
+	}
+	dirty_ = false;
+    }
+    return SDL_RenderCopy(renderer_, target_, nullptr, nullptr);
+}
+
+int LayerCache::paint() {
+    if (SDL_SetRenderDrawColor(renderer_, 0xff, 0xff, 0xff, 0xff) != 0 ||
+	SDL_RenderClear(renderer_) != 0) {
+	return -1;
+    }
+    for (const Painter& layer : layers_) {
+	if (layer(renderer_) != 0) {
+	    return -1;
+	}
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#ifndef SPACEPIG_LAYERCACHE_H
+#define SPACEPIG_LAYERCACHE_H
+
+#include <SDL.h>
+#include <functional>
+#include <vector>
+
+namespace spacePig {
+
+/**
+ * Caches the static layers of a frame, such as the background and any
+ * HUD chrome, flattened into one render target. Each frame then starts
+ * with a single unblended copy of that target, which also stands in
+ * for clearing the screen, however many static layers there are.
+ *
+ * The layers are only painted again when one of them is marked dirty,
+ * or after the renderer has lost its render targets. A renderer
+ * without render targets gets the layers painted straight into every
+ * frame over a clear, as before.
+ */
+class LayerCache {
+public:
+    /**
+     * Paints one layer with the renderer.
+     * @return 0 on success, or a negative SDL error code
+     */
+    typedef std::function<int(SDL_Renderer*)> Painter;
+
+    /**
+     * Construct a cache with no layers. No render target is made
+     * until the first draw.
+     */
+    LayerCache(/** renderer to draw with */ SDL_Renderer* renderer,
+	    /** width of the screen */ int width,
+	    /** height of the screen */ int height);
+
+    /**
+     * Release the render target.
+     */
+    ~LayerCache();
+
+    LayerCache(const LayerCache&) = delete;
+    LayerCache& operator=(const LayerCache&) = delete;
+
+    /**
+     * Add a layer on top of the others. It is first painted at the
+     * next draw.
+     * @return the layer's handle
+     */
+    int addLayer(/** paints the layer */ Painter painter);
+
+    /**
+     * Mark a layer as changed, so the layers are painted again at the
+     * next draw.
+     */
+    void invalidate(/** handle of the layer */ int layer) noexcept;
+
+    /**
+     * Drop the render target, for when the renderer has lost it, so
+     * it is made and painted again at the next draw.
+     */
+    void reset() noexcept;
+
+    /**
+     * Draw the layers into the current render target, painting the
+     * cache again first if anything changed. The screen is covered
+     * completely, so it need not be cleared first.
+     * @return 0 on success, or a negative SDL error code
+     */
+    int draw();
+
+    /**
+     * Whether or not the layers are cached in a render target.
+     * @return false if they are painted into every frame
+     */
+    bool isCached() const noexcept;
+
+private:
+    /** renderer to draw with */
+    SDL_Renderer* renderer_;
+
+    /** width of the screen */
+    int width_;
+
+    /** height of the screen */
+    int height_;
+
+    /** the layers, bottom first */
+    std::vector<Painter> layers_;
+
+    /** the flattened layers, or null until made */
+    SDL_Texture* target_ = nullptr;
+
+    /** whether the renderer supports render targets at all */
+    bool supported_ = false;
+
+    /** whether the flattened layers are out of date */
+    bool dirty_ = true;
+
+    /**
+     * Clear the current render target to opaque white and paint every
+     * layer into it.
+     * @return 0 on success, or a negative SDL error code
+     */
+    int paint();
+};
+
+}
+
+#endif
@@ -0,0 +1,307 @@
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Pattern.h"
+#include "ProjectilePool.h"
+#include "ProjectileType.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** degrees to radians */
+const double radians = 3.14159265358979323846 / 180.0;
+
+/** the operands an instruction takes */
+struct Syntax {
+    const char* word;
+    Pattern::Op op;
+    /** 'n' for a count, 'f' for a number, 'b' for on/off, 0 for none */
+    char first;
+    char second;
+};
+
+const Syntax syntax[] = {
+    { "origin", Pattern::Origin, 'f', 'f' },
+    { "speed",  Pattern::Speed,  'f', 0 },
+    { "type",   Pattern::Type,   'n', 0 },
+    { "angle",  Pattern::Angle,  'f', 0 },
+    { "turn",   Pattern::Turn,   'f', 0 },
+    { "aim",    Pattern::Aim,    0,   0 },
+    { "mirror", Pattern::Mirror, 'b', 0 },
+    { "ring",   Pattern::Ring,   'n', 0 },
+    { "fan",    Pattern::Fan,    'n', 'f' },
+    { "wait",   Pattern::Wait,   'f', 0 },
+    { "repeat", Pattern::Repeat, 'n', 0 },
+    { "end",    Pattern::End,    0,   0 },
+};
+
+/** read one operand into an instruction, or return false */
+bool operand(istringstream& in, char kind, bool first, Pattern::Instruction& inst) {
+    if (kind == 'n') {
+	long count;
+	if (!(in >> count) || count < 0 || count > 65535) {
+	    return false;
+	}
+	inst.count = (unsigned short)(count);
+    }
+    else if (kind == 'b') {
+	string flag;
+	in >> flag;
+	if (flag != "on" && flag != "off") {
+	    return false;
+	}
+	inst.count = flag == "on";
+    }
+    else {
+	float value;
+	if (!(in >> value)) {
+	    return false;
+	}
+	(first ? inst.a : inst.b) = value;
+    }
+    return true;
+}
+
+/** fold raw bytes into a 64-bit FNV-1a hash */
+void fnv(unsigned long long& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t ii = 0; ii < size; ii++) {
+	hash = (hash ^ bytes[ii]) * 1099511628211ULL;
+    }
+}
+
+}
+
+vector<Pattern> Pattern::load(const string& path) {
+    ifstream file(path);
+    if (!file) {
+	throw domain_error("Unable to open pattern file " + path);
+    }
+
+    vector<Pattern> patterns;
+    // the open repeats, and whether each has reached a positive wait
+    vector<int> open;
+    vector<bool> waits;
+    // projectiles the pattern emits, not counting mirror images, and
+    // whether it ever mirrors them
+    double emitted = 0.0;
+    bool mirrors = false;
+    string line;
+    int number = 0;
+    auto fail = [&](const string& message) {
+	throw domain_error(path + ":" + to_string(number) + ": " + message);
+    };
+    auto budget = [&]() {
+	double total = emitted * (mirrors ? 2.0 : 1.0);
+	if (total > maxProjectiles) {
+	    fail("pattern emits more than " + to_string(maxProjectiles) + " projectiles");
+	}
+	return int(total);
+    };
+    auto close = [&]() {
+	if (!open.empty()) {
+	    fail("missing \"end\" in pattern " + patterns.back().name_);
+	}
+	if (!patterns.empty()) {
+	    patterns.back().projectiles_ = budget();
+	}
+	emitted = 0.0;
+	mirrors = false;
+    };
+
+    while (getline(file, line)) {
+	number++;
+	istringstream in(line.substr(0, line.find('#')));
+	string word;
+	if (!(in >> word)) {
+	    continue;
+	}
+
+	if (word == "pattern") {
+	    close();
+	    patterns.push_back(Pattern());
+	    if (!(in >> patterns.back().name_)) {
+		fail("pattern needs a name");
+	    }
+	}
+	else {
+	    const Syntax* found = nullptr;
+	    for (const Syntax& entry : syntax) {
+		if (word == entry.word) {
+		    found = &entry;
+		}
+	    }
+	    if (!found) {
+		fail("unknown instruction \"" + word + "\"");
+	    }
+	    if (patterns.empty()) {
+		fail("\"" + word + "\" before the first pattern");
+	    }
+
+	    Instruction inst = { found->op, 0, 0.0f, 0.0f };
+	    if ((found->first && !operand(in, found->first, true, inst))
+		|| (found->second && !operand(in, found->second, false, inst))) {
+		fail("bad operand for \"" + word + "\"");
+	    }
+	    string extra;
+	    if (in >> extra) {
+		fail("unexpected \"" + extra + "\"");
+	    }
+
+	    vector<Instruction>& program = patterns.back().program_;
+	    if (program.size() >= 65535) {
+		fail("pattern is too long");
+	    }
+	    if (inst.op == Type && inst.count >= ProjectileTypes::size()) {
+		fail("no projectile type " + to_string(inst.count));
+	    }
+	    if (inst.op == Wait && inst.a < 0.0f) {
+		fail("wait cannot be negative");
+	    }
+	    if (inst.op == Wait && inst.a > 0.0f) {
+		waits.assign(waits.size(), true);
+	    }
+	    if (inst.op == Mirror && inst.count) {
+		mirrors = true;
+		budget();
+	    }
+	    if (inst.op == Ring || inst.op == Fan) {
+		// every pass of every enclosing repeat emits again
+		double passes = 1.0;
+		for (int start : open) {
+		    passes *= program[start].count;
+		}
+		emitted += passes * inst.count;
+		budget();
+	    }
+	    if (inst.op == Repeat) {
+		if (inst.count == 0) {
+		    fail("repeat needs a count of at least 1");
+		}
+		if (int(open.size()) >= maxDepth) {
+		    fail("repeats nested too deep");
+		}
+		open.push_back(int(program.size()));
+		waits.push_back(false);
+	    }
+	    else if (inst.op == End) {
+		if (open.empty()) {
+		    fail("\"end\" without \"repeat\"");
+		}
+		// a loop that never waits would run every pass in one tick
+		if (!waits.back()) {
+		    fail("repeat never waits, it needs a \"wait\" longer than 0");
+		}
+		inst.count = (unsigned short)(open.back());
+		open.pop_back();
+		waits.pop_back();
+	    }
+	    program.push_back(inst);
+	}
+    }
+    close();
+    return patterns;
+}
+
+const string& Pattern::getName() const noexcept {
+    return name_;
+}
+
+const vector<Pattern::Instruction>& Pattern::getProgram() const noexcept {
+    return program_;
+}
+
+int Pattern::getMaxProjectiles() const noexcept {
+    return projectiles_;
+}
+
+PatternEmitter::PatternEmitter(const Pattern& pattern, int width) noexcept :
+    program_(&pattern.getProgram()),
+    x_(width / 2.0f),
+    width_(width)
+    {}
+
+bool PatternEmitter::isFinished() const noexcept {
+    return !program_ || pc_ >= int(program_->size());
+}
+
+void PatternEmitter::update(double delta, float targetX, float targetY,
+    ProjectilePool& pool) {
+    if (isFinished()) {
+	return;
+    }
+
+    // run instructions until the pattern waits or ends, or until it
+    // has run its share for one update
+    wait_ -= delta;
+    const Pattern::Instruction* code = program_->data();
+    int size = int(program_->size());
+    for (int run = 0; wait_ <= 0.0 && pc_ < size && run < maxRun; run++) {
+	const Pattern::Instruction& inst = code[pc_++];
+	switch (inst.op) {
+	    case Pattern::Origin: x_ = inst.a; y_ = inst.b; break;
+	    case Pattern::Speed: speed_ = inst.a; break;
+	    case Pattern::Type: type_ = inst.count; break;
+	    case Pattern::Angle: angle_ = inst.a; break;
+	    case Pattern::Turn: angle_ += inst.a; break;
+	    case Pattern::Aim:
+		angle_ = float(atan2(targetX - x_, targetY - y_) / radians);
+		break;
+	    case Pattern::Mirror: mirror_ = inst.count != 0; break;
+	    case Pattern::Ring:
+		emit(inst.count, angle_, 360.0f, inst.count, pool);
+		break;
+	    case Pattern::Fan:
+		if (inst.count == 1) {
+		    emit(1, angle_, 0.0f, 1, pool);
+		    break;
+		}
+		emit(inst.count, angle_ - inst.b / 2, inst.b, inst.count - 1, pool);
+		break;
+	    case Pattern::Wait: wait_ += inst.a; break;
+	    case Pattern::Repeat: loops_[depth_++] = inst.count - 1; break;
+	    case Pattern::End:
+		// jump back past the repeat, or fall out of the loop
+		if (loops_[depth_ - 1] > 0) {
+		    loops_[depth_ - 1]--;
+		    pc_ = inst.count + 1;
+		}
+		else {
+		    depth_--;
+		}
+		break;
+	}
+    }
+}
+
+unsigned long long PatternEmitter::getStateHash() const noexcept {
+    // field by field, so padding never reaches the hash, and only the
+    // repeats that are open
+    unsigned long long hash = 14695981039346656037ULL;
+    fnv(hash, &pc_, sizeof(pc_));
+    fnv(hash, &wait_, sizeof(wait_));
+    fnv(hash, &x_, sizeof(x_));
+    fnv(hash, &y_, sizeof(y_));
+    fnv(hash, &angle_, sizeof(angle_));
+    fnv(hash, &speed_, sizeof(speed_));
+    fnv(hash, &type_, sizeof(type_));
+    fnv(hash, &mirror_, sizeof(mirror_));
+    fnv(hash, &width_, sizeof(width_));
+    fnv(hash, &depth_, sizeof(depth_));
+    fnv(hash, loops_, depth_ * sizeof(*loops_));
+    return hash;
+}
+
+void PatternEmitter::emit(int count, float first, float spread, int steps,
+    ProjectilePool& pool) {
+    float speed = speed_;
+    pool.emitRun(x_, y_, count, type_, mirror_, width_ - x_,
+	[first, spread, steps, speed](int ii, float& vx, float& vy) {
+	    float angle = first + spread * ii / steps;
+	    vx = float(speed * sin(angle * radians));
+	    vy = float(speed * cos(angle * radians));
+	});
+}
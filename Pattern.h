@@ -0,0 +1,207 @@
+#ifndef SPACEPIG_PATTERN_H
+#define SPACEPIG_PATTERN_H
+
+#include <string>
+#include <vector>
+
+namespace spacePig {
+
+class ProjectilePool;
+
+/**
+ * A bullet pattern compiled to a flat instruction stream.
+ *
+ * Patterns are written one instruction per line in a text file, and
+ * a file may hold several patterns, each starting with a "pattern"
+ * line. Angles are in degrees, with 0 pointing straight down the
+ * screen and 90 pointing right, and times are in simulated seconds.
+ *
+ *     pattern NAME       start a new pattern
+ *     origin X Y         move the emitter
+ *     speed S            speed of the projectiles emitted from here on
+ *     type ID            ProjectileTypes id of those projectiles
+ *     angle A            point the emitter
+ *     turn A             turn the emitter
+ *     aim                point the emitter at the player
+ *     mirror on|off      also emit every projectile mirrored left to right
+ *     ring N             emit N projectiles evenly around the emitter
+ *     fan N SPREAD       emit N projectiles across SPREAD degrees
+ *     wait T             pause before the next instruction
+ *     repeat N           run the lines up to the matching "end" N times
+ *     end
+ *
+ * Anything after a '#' is a comment.
+ *
+ * Every repeat has to wait for longer than 0 somewhere inside it, and
+ * a pattern may emit at most maxProjectiles projectiles in all, so
+ * the room a pattern needs is known once it has compiled.
+ */
+class Pattern {
+public:
+    /** deepest nesting of repeats */
+    static const int maxDepth = 8;
+
+    /** most projectiles one pattern may emit, mirror images included */
+    static const int maxProjectiles = 100000;
+
+    /**
+     * Instruction opcodes.
+     */
+    enum Op : unsigned char {
+	Origin, Speed, Type, Angle, Turn, Aim, Mirror, Ring, Fan, Wait, Repeat, End
+    };
+
+    /**
+     * One compiled instruction, 12 bytes.
+     */
+    struct Instruction {
+	/** what to do */
+	Op op;
+
+	/** projectile count, repeat count, type id, mirror flag, or for
+	 *  End the index of the matching Repeat */
+	unsigned short count;
+
+	/** first operand */
+	float a;
+
+	/** second operand */
+	float b;
+    };
+
+    /**
+     * Compile every pattern in a file.
+     * @return the patterns in the order they appear
+     * @throw domain_error if the file could not be read or does not compile,
+     * naming the offending line, such as when a repeat never waits or a
+     * pattern emits more than maxProjectiles projectiles.
+     */
+    static std::vector<Pattern> load(/** path of the pattern file */ const std::string& path);
+
+    /**
+     * The name the pattern was given in its file.
+     * @return the pattern name
+     */
+    const std::string& getName() const noexcept;
+
+    /**
+     * The compiled instructions.
+     * @return the instruction stream
+     */
+    const std::vector<Instruction>& getProgram() const noexcept;
+
+    /**
+     * The most projectiles the pattern can emit, counting every
+     * projectile as mirrored if the pattern ever mirrors.
+     * @return the projectile count
+     */
+    int getMaxProjectiles() const noexcept;
+
+private:
+    /** name of the pattern */
+    std::string name_;
+
+    /** compiled instructions */
+    std::vector<Instruction> program_;
+
+    /** most projectiles the pattern can emit */
+    int projectiles_ = 0;
+};
+
+/**
+ * Runs a compiled pattern, emitting its projectiles straight into a
+ * pool. An emitter is a handful of registers and a fixed-depth loop
+ * stack, so running one never allocates beyond the pool's growth.
+ */
+class PatternEmitter {
+public:
+    /**
+     * Most instructions one update() runs, however long it covers.
+     * The rest run at the next update.
+     */
+    static const int maxRun = 4096;
+
+    /**
+     * Construct an emitter that has nothing to run.
+     */
+    PatternEmitter() = default;
+
+    /**
+     * Construct an emitter at the start of a pattern. The pattern
+     * must outlive the emitter.
+     */
+    explicit PatternEmitter(/** pattern to run */ const Pattern& pattern,
+	    /** width of the screen */ int width = 450) noexcept;
+
+    /**
+     * Whether or not the pattern has run to its end.
+     * @return true if there is nothing left to emit
+     */
+    bool isFinished() const noexcept;
+
+    /**
+     * A 64-bit FNV-1a hash of where the emitter is in its program and
+     * everything it has set so far, so replays can tell two runs that
+     * emitted the same projectiles but will go on differently.
+     * @return the hash of the emitter's state
+     */
+    unsigned long long getStateHash() const noexcept;
+
+    /**
+     * Run the pattern over delta time, emitting into a pool every
+     * projectile that comes due.
+     */
+    void update(/** time */ double delta,
+	    /** x-coordinate "aim" points at */ float targetX,
+	    /** y-coordinate "aim" points at */ float targetY,
+	    /** pool to emit into */ ProjectilePool& pool);
+
+private:
+    /** the program being run */
+    const std::vector<Pattern::Instruction>* program_ = nullptr;
+
+    /** index of the next instruction */
+    int pc_ = 0;
+
+    /** seconds left to wait before the next instruction */
+    double wait_ = 0.0;
+
+    /** emitter position */
+    float x_ = 0.0f;
+    float y_ = 0.0f;
+
+    /** emitter heading in degrees */
+    float angle_ = 0.0f;
+
+    /** speed of emitted projectiles */
+    float speed_ = 200.0f;
+
+    /** type of emitted projectiles */
+    int type_ = 0;
+
+    /** whether to mirror every projectile left to right */
+    bool mirror_ = false;
+
+    /** width of the screen, for mirroring */
+    int width_ = 450;
+
+    /** passes left after the current one, per open repeat, innermost last */
+    int loops_[Pattern::maxDepth] = {};
+
+    /** number of open repeats */
+    int depth_ = 0;
+
+    /**
+     * Emit a run of projectiles in one batch, and their mirror images
+     * if mirroring. The iith heads first + spread * ii / steps degrees.
+     */
+    void emit(/** number of projectiles */ int count,
+	    /** heading of the first in degrees */ float first,
+	    /** degrees across all the steps */ float spread,
+	    /** number of steps the spread is divided into */ int steps,
+	    ProjectilePool& pool);
+};
+
+}
+
+#endif
@@ -23,28 +23,32 @@ int Player::getDiameter() const noexcept {
 	return int(2.0 * radius_ + 0.5);
 }
 
+double Player::getVelocity() const noexcept {
+	return velocity_;
+}
+
 std::string Player::getFileLoc() const noexcept {
     return fileLocation_;
 }
 
-void Player::move(std::string dir, double delta) noexcept {
-    // input is left, check bounds against left side
-    if (dir.compare("left") == 0 && (posx_ - radius_ >= 0)) {
+void Player::move(unsigned directions, double delta) noexcept {
+    // moving left, check bounds against left side
+    if ((directions & Left) && (posx_ - radius_ >= 0)) {
 	posx_ -= (velocity_ * delta);
     }
 
-    // input is right, check bounds against right side
-    if (dir.compare("right") == 0 && (posx_ + radius_ < width_)) {
+    // moving right, check bounds against right side
+    if ((directions & Right) && (posx_ + radius_ < width_)) {
 	posx_ += (velocity_ * delta);
     }
 
-    // input is up, check bounds against top of screen	
-    if (dir.compare("up") == 0 && (posy_ - radius_ >= (velocity_ * delta))) {
+    // moving up, check bounds against top of screen	
+    if ((directions & Up) && (posy_ - radius_ >= (velocity_ * delta))) {
 	posy_ -= (velocity_ * delta);
     }
 
-    // input is down, check bounds against bottom of screen
-    if (dir.compare("down") == 0 && (posy_ + radius_ < height_)) {
+    // moving down, check bounds against bottom of screen
+    if ((directions & Down) && (posy_ + radius_ < height_)) {
 	posy_ += (velocity_ * delta);
     }
 }
@@ -60,18 +64,18 @@ void Player::move(int x, int y) noexcept {
     }
 }
 
+Circle Player::getBody() const noexcept {
+    Circle body = { posx_, posy_, double(radius_) };
+    return body;
+}
+
 bool Player::hasDied(const Wave& currWave) const noexcept {
-    // all of the projectiles released for this wave so far
-    std::vector<Projectile> onScreen = currWave.getReleased();
-
-    // check for a collision against each projectile that has been released
-    for (auto proj : onScreen) {
-	double dx = proj.getX() - posx_;
-	double dy = proj.getY() - posy_;
-	double dist2 = dx * dx + dy * dy;
-	if (dist2 < ((proj.getDiameter() / 2) + radius_) * ((proj.getDiameter() / 2) + radius_)) {
-	    return true;
-	}
-    }
-    return false;
+    return hasDied(currWave, getBody());
+}
+
+bool Player::hasDied(const Wave& currWave, const Circle& from) const noexcept {
+    // follow the player and the released projectiles near its path
+    // through the tick, so a long tick cannot step over a hit
+    Circle body = getBody();
+    return currWave.sweeps(&from, &body);
 }
@@ -14,6 +14,16 @@ namespace spacePig {
 
 class Player {
 public:
+    /**
+     * Directions the player can be steered in. Combine them with |
+     * to move diagonally.
+     */
+    enum Direction : unsigned {
+	Left = 1,
+	Right = 2,
+	Up = 4,
+	Down = 8
+    };
 
     /* Constructs a player. The player must know the bounds
      * of the window so that it does not go off screen.
@@ -38,6 +48,12 @@ public:
      * @return the diameter of the player's character
      */
     int getDiameter() const noexcept;
+
+    /*
+     * How fast the player moves while its controls are held.
+     * @return the velocity in pixels per simulated second
+     */
+    double getVelocity() const noexcept;
 	
     /*
      * The string file location storing where the player's image is.
@@ -46,10 +62,10 @@ public:
     std::string getFileLoc() const noexcept;
 
     /*
-     * Moves the player in a certain direction over delta time.
+     * Moves the player in a set of directions over delta time.
      * Ensures the player is not moving beyond the boundaries of the game.
      */
-    void move(/** which side to move player */ std::string dir, 
+    void move(/** Direction flags to move the player in */ unsigned directions, 
 		/** time */ double delta = 0.01) noexcept;
 
     /*
@@ -59,27 +75,47 @@ public:
     void move(/** x-coord destination */ int x, 
 		/** y-coord destination */ int y) noexcept; 
 
+    /*
+     * The player's hitbox.
+     * @return a circle around the player's center
+     */
+    Circle getBody() const noexcept;
+
     /*
      * Check if the player has been hit by any of the projectiles
-     * in the current wave. If the player has been hit, the game is over 
+     * in the current wave at any time during its last tick, standing
+     * where it is now. If the player has been hit, the game is over 
      * and they must restart.
      * @return true if the player has died
      */
     bool hasDied(/** Current wave for game*/ const Wave& currWave) const noexcept;
+
+    /*
+     * Check if the player has been hit by any of the projectiles
+     * in the current wave at any time during its last tick, moving
+     * in a straight line from where it started the tick to where it
+     * is now.
+     * @return true if the player has died
+     */
+    bool hasDied(/** Current wave for game*/ const Wave& currWave,
+		/** the player's hitbox at the start of the tick */ const Circle& from) const noexcept;
 	
 private:
     /** The player's velocity */
     double velocity_ = 750.0;
 
+    /**
+     * The radius of the player's character. Declared before the
+     * position, which the constructor derives from it.
+     */
+    int radius_ = 10;
+
     /** The player's x-coordinate */
     double posx_ = 0.0;
 
     /** The player's y-coordinate */
     double posy_ = 0.0;
 
-    /** The radius of the player's character */
-    int radius_ = 10;
-
     /** The width of the game's screen */
     int width_ = 0;
 
@@ -1,72 +1,63 @@
 #include <vector>
-#include <random>
 #include <stdexcept>
 #include "Projectile.h"
 
 using namespace std;
 using namespace spacePig;
 
-Projectile::Projectile(std::mt19937& engine, int wave, int width, int height) :
-    realDistribution_(0.0, 1.0),
-
-    width_(width),
-    height_(height),
-
-    posx_(realDistribution_(engine) * width_),
-    posy_(-10.0),
-    vy_{realDistribution_(engine) * 500.00 + 150.0}
+Projectile::Projectile(CounterRng rng, int wave, const WaveParams& params,
+    int width, int type) :
+    posx_(float(rng.nextDouble() * width)),
+    posy_(-10.0f),
+    vy_(float(rng.nextDouble() * params.vyRange + params.vyMin)),
+    type_((unsigned char)(type))
 
     {
-	int rnd = int(realDistribution_(engine) * 10);
+	int rnd = int(rng.nextDouble() * 10);
 	if (rnd % 2 == 0) {
-	    vx_ = realDistribution_(engine) * 600.00 + (wave * 50.0);
+	    vx_ = float(rng.nextDouble() * params.vxRange + (wave * params.vxPerWave));
 	}
 	else {
-	    vx_ = -realDistribution_(engine) * 600.00 + (wave * 50.0);
+	    vx_ = float(-rng.nextDouble() * params.vxRange + (wave * params.vxPerWave));
 	}
 }
 
 int Projectile::getX() const noexcept {
-    return int(posx_ - radius_ + 0.5);
+    return int(posx_ - getRadius() + 0.5);
 }
 
 int Projectile::getY() const noexcept {
-    return int(posy_ - radius_ + 0.5);
+    return int(posy_ - getRadius() + 0.5);
 }
 
 int Projectile::getDiameter() const noexcept {
-    return int(2.0 * radius_ + 0.5);
+    return int(2.0 * getRadius() + 0.5);
 }
 
-std::string Projectile::getFileLoc() const noexcept {
-    return fileLocation_;
+double Projectile::getCenterX() const noexcept {
+    return posx_;
 }
 
-bool Projectile::offScreen() const noexcept {
-    return offScreen_;
+double Projectile::getCenterY() const noexcept {
+    return posy_;
 }
 
-void Projectile::move(double delta) noexcept {
-    if (canMove_) {
-	posx_ += delta * vx_;
-	posy_ += delta * vy_;
-	// Bounce against walls
-	if (posx_ < radius_) {
-	    posx_ = 2 * radius_ - posx_;
-	    vx_ = -vx_;
-	}
+double Projectile::getVelocityX() const noexcept {
+    return vx_;
+}
 
-	if (posx_ > width_ - radius_) {
-	    posx_ = 2 * (width_ - radius_) - posx_;
-	    vx_ = -vx_;
-        }
-    }
+double Projectile::getVelocityY() const noexcept {
+    return vy_;
+}
+
+double Projectile::getRadius() const noexcept {
+    return ProjectileTypes::get(type_).radius;
+}
 
-    if (posy_ - radius_ > height_) {
-	offScreen_ = true;
-    }
+int Projectile::getType() const noexcept {
+    return type_;
 }
 
-void Projectile::allowMove() noexcept {
-    canMove_ = true;
+std::string Projectile::getFileLoc() const noexcept {
+    return ProjectileTypes::get(type_).fileLocation;
 }
@@ -1,26 +1,31 @@
 #ifndef SPACEPIG_PROJECTILE_H
 #define SPACEPIG_PROJECTILE_H
 
-#include <random>
 #include <string>
+#include "CounterRng.h"
+#include "ProjectileType.h"
+#include "WaveParams.h"
 
 namespace spacePig {
 /**
  * Represents one single projectile.
  * Each projectile has an (x, y) position and a speed that
- * is determined randomly based on the wave the projectile 
- * belongs to. 
+ * is determined randomly based on the wave the projectile
+ * belongs to. Its image, radius and behavior come from its
+ * ProjectileType, so a projectile is only a few floats and a
+ * type id.
  *
- * If a player hits a projectile, they die. 
+ * If a player hits a projectile, they die.
  */
 
 class Projectile {
 public:
 
-    Projectile(/** Random number generator */ std::mt19937& engine,
+    Projectile(/** Random stream of this projectile */ CounterRng rng,
 		/** wave of the projectile */ int wave,
+		/** how to generate the projectile */ const WaveParams& params = WaveParams(),
 		/** width of the screen */ int width = 450,
-		/** height of the screen */ int height = 800);
+		/** id of the projectile's type */ int type = ProjectileTypes::standard);
 
     /**
      * The x coordinate of the center of the projectile
@@ -38,66 +43,67 @@ public:
      * The diameter of the projectile
      * @return the diameter of the projectile.
      */
-    int getDiameter() const noexcept;    
+    int getDiameter() const noexcept;
 
     /**
-     * The file location of the projectile image.
-     * @return the location of the projectile image
+     * The exact x coordinate of the center of the projectile
+     * @return the x coordinate of the center
      */
-    std::string getFileLoc() const noexcept;
+    double getCenterX() const noexcept;
 
     /**
-     * Determines whether or not the projectile has fallen off
-     * the bottom of the screen and needs to be removed.
+     * The exact y coordinate of the center of the projectile
+     * @return the y coordinate of the center
      */
-    bool offScreen() const noexcept;
+    double getCenterY() const noexcept;
 
     /**
-     * Move the projectile over delta time
+     * The x velocity of the projectile
+     * @return the x velocity
      */
-    void move(/** The interval of time during which the sprite moves. */ double delta) noexcept; 
+    double getVelocityX() const noexcept;
 
     /**
-     * set the projectile from waiting to being released. 
-     * Projectiles are released as the wave progresses.
+     * The y velocity of the projectile
+     * @return the y velocity
      */
-    void allowMove() noexcept;
-
-private:
-    /** a real distribution for RNG */
-    std::uniform_real_distribution<double> realDistribution_;
+    double getVelocityY() const noexcept;
 
-    /** the radius of the projectile image */
-    double radius_ = 5.0;
+    /**
+     * The radius of the projectile
+     * @return the radius of the projectile
+     */
+    double getRadius() const noexcept;
 
-    /** width of the game display */
-    int width_ = 450;
+    /**
+     * The id of the projectile's type
+     * @return the type id
+     */
+    int getType() const noexcept;
 
-    /** height of the game display */
-    int height_ = 800;
+    /**
+     * The file location of the projectile image.
+     * @return the location of the projectile image
+     */
+    std::string getFileLoc() const noexcept;
 
+private:
     /** x-coordinate of this projectile */
-    double posx_ = 0.0;
+    float posx_ = 0.0f;
 
     /** y-coordinate of this projectile */
-    double posy_ = -10.0;
+    float posy_ = -10.0f;
 
     /** x velocity of this projectile */
-    double vx_ = 0.0;
+    float vx_ = 0.0f;
 
     /** y velocity of this projectile */
-    double vy_ = 1.0;
-
-    /** whether or not this projectile can move */
-    bool canMove_ = false;
-
-    /** whether or not this projectile is on screen */
-    bool offScreen_ = false;
+    float vy_ = 1.0f;
 
-    /** the file location of the projectile image */
-    std::string fileLocation_ = "graphics/projectile.png";
+    /** id of the projectile's type */
+    unsigned char type_ = ProjectileTypes::standard;
 };
 
 }
 
-#endif 
+#endif
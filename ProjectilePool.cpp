@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <limits>
+#include "ProjectilePool.h"
+#include "ProjectileStep.h"
+
+using namespace std;
+using namespace spacePig;
+
+ProjectileRef::ProjectileRef(const ProjectilePool& pool, int index) noexcept :
+    pool_(&pool),
+    index_(index)
+    {}
+
+int ProjectileRef::getX() const noexcept {
+    return int(getCenterX() - getRadius() + 0.5);
+}
+
+int ProjectileRef::getY() const noexcept {
+    return int(getCenterY() - getRadius() + 0.5);
+}
+
+int ProjectileRef::getX(double alpha) const noexcept {
+    double prev = pool_->prevx()[index_];
+    return int(prev + (getCenterX() - prev) * alpha - getRadius() + 0.5);
+}
+
+int ProjectileRef::getY(double alpha) const noexcept {
+    double prev = pool_->prevy()[index_];
+    return int(prev + (getCenterY() - prev) * alpha - getRadius() + 0.5);
+}
+
+int ProjectileRef::getDiameter() const noexcept {
+    return int(2.0 * getRadius() + 0.5);
+}
+
+double ProjectileRef::getCenterX() const noexcept {
+    return pool_->posx()[index_];
+}
+
+double ProjectileRef::getCenterY() const noexcept {
+    return pool_->posy()[index_];
+}
+
+double ProjectileRef::getVelocityX() const noexcept {
+    return pool_->vx()[index_];
+}
+
+double ProjectileRef::getVelocityY() const noexcept {
+    return pool_->vy()[index_];
+}
+
+double ProjectileRef::getRadius() const noexcept {
+    return ProjectileTypes::get(getType()).radius;
+}
+
+int ProjectileRef::getType() const noexcept {
+    return pool_->type()[index_];
+}
+
+ProjectileView::iterator::iterator(const ProjectilePool* pool, int index) noexcept :
+    pool_(pool),
+    index_(index)
+    {}
+
+ProjectileRef ProjectileView::iterator::operator*() const noexcept {
+    return ProjectileRef(*pool_, index_);
+}
+
+ProjectileView::iterator& ProjectileView::iterator::operator++() noexcept {
+    index_++;
+    return *this;
+}
+
+bool ProjectileView::iterator::operator!=(const iterator& other) const noexcept {
+    return index_ != other.index_;
+}
+
+bool ProjectileView::iterator::operator==(const iterator& other) const noexcept {
+    return index_ == other.index_;
+}
+
+ProjectileView::ProjectileView(const ProjectilePool& pool, int first, int last) noexcept :
+    pool_(&pool),
+    first_(first),
+    last_(last)
+    {}
+
+int ProjectileView::size() const noexcept {
+    return last_ - first_;
+}
+
+bool ProjectileView::empty() const noexcept {
+    return last_ == first_;
+}
+
+ProjectileRef ProjectileView::operator[](int index) const noexcept {
+    return ProjectileRef(*pool_, first_ + index);
+}
+
+ProjectileView::iterator ProjectileView::begin() const noexcept {
+    return iterator(pool_, first_);
+}
+
+ProjectileView::iterator ProjectileView::end() const noexcept {
+    return iterator(pool_, last_);
+}
+
+const ProjectilePool& ProjectileView::pool() const noexcept {
+    return *pool_;
+}
+
+int ProjectileView::first() const noexcept {
+    return first_;
+}
+
+ProjectilePool::ProjectilePool(int width, int height, Arena* arena) :
+    posx_(ArenaAllocator<float>(arena)),
+    posy_(ArenaAllocator<float>(arena)),
+    prevx_(ArenaAllocator<float>(arena)),
+    prevy_(ArenaAllocator<float>(arena)),
+    vx_(ArenaAllocator<float>(arena)),
+    vy_(ArenaAllocator<float>(arena)),
+    type_(ArenaAllocator<unsigned char>(arena)),
+    offScreen_(ArenaAllocator<unsigned char>(arena)),
+    width_(width),
+    height_(height) {
+    updateWalls();
+}
+
+int ProjectilePool::size() const noexcept {
+    return count_;
+}
+
+bool ProjectilePool::empty() const noexcept {
+    return count_ == 0;
+}
+
+void ProjectilePool::reserve(int count) {
+    posx_.reserve(count);
+    posy_.reserve(count);
+    prevx_.reserve(count);
+    prevy_.reserve(count);
+    vx_.reserve(count);
+    vy_.reserve(count);
+    type_.reserve(count);
+    offScreen_.reserve(count);
+}
+
+void ProjectilePool::push(const Projectile& proj) {
+    append(float(proj.getCenterX()), float(proj.getCenterY()),
+	float(proj.getVelocityX()), float(proj.getVelocityY()), proj.getType());
+}
+
+void ProjectilePool::emit(float posx, float posy, float vx, float vy, int type) {
+    append(posx, posy, vx, vy, type);
+}
+
+void ProjectilePool::retire(int index) noexcept {
+    // swap the last live projectile into the hole
+    int last = --count_;
+    posx_[index] = posx_[last];
+    posy_[index] = posy_[last];
+    prevx_[index] = prevx_[last];
+    prevy_[index] = prevy_[last];
+    vx_[index] = vx_[last];
+    vy_[index] = vy_[last];
+    type_[index] = type_[last];
+}
+
+void ProjectilePool::clear() noexcept {
+    count_ = 0;
+    stepped_ = 0;
+}
+
+void ProjectilePool::step(double delta) noexcept {
+    // retire what the last step flagged, walking backwards so the
+    // projectile swapped into a retired slot has already been checked.
+    // Anything added since then sits past stepped_ and is never flagged.
+    for (int ii = stepped_ - 1; ii >= 0; ii--) {
+	if (offScreen_[ii]) {
+	    retire(ii);
+	}
+    }
+
+    // remember where everything was for render interpolation
+    // and for collision tests along the step
+    copy_n(posx_.begin(), count_, prevx_.begin());
+    copy_n(posy_.begin(), count_, prevy_.begin());
+
+    // integrate the whole pool in one batch, flagging what fell off
+    if (wallTypes_ != ProjectileTypes::size()) {
+	updateWalls();
+    }
+    StepWalls walls = { left_, right_, bottom_,
+	-margin_, float(width_) + margin_, -margin_ };
+    stepDelta_ = float(delta);
+    stepProjectiles(posx_.data(), posy_.data(), vx_.data(), vy_.data(),
+	type_.data(), count_, stepDelta_, walls, offScreen_.data());
+    stepped_ = count_;
+}
+
+float ProjectilePool::getStepDelta() const noexcept {
+    return stepDelta_;
+}
+
+float ProjectilePool::getBounceTime(int index) const noexcept {
+    if (index >= stepped_) {
+	return -1.0f;
+    }
+
+    // redo the kernel's unbounced move exactly; if it lands where the
+    // projectile is, it did not bounce
+    float from = prevx_[index];
+    float vx = vx_[index];
+    float ahead = from + stepDelta_ * vx;
+    if (ahead == posx_[index]) {
+	return -1.0f;
+    }
+
+    // it bounced, so it was heading the other way, at the wall
+    // opposite its new heading
+    float wall = vx > 0.0f ? left_[type_[index]] : right_[type_[index]];
+    float unbounced = from - stepDelta_ * vx;
+    return min(max((wall - from) / (unbounced - from), 0.0f), 1.0f);
+}
+
+ProjectileView ProjectilePool::view() const noexcept {
+    return ProjectileView(*this, 0, count_);
+}
+
+ProjectileView ProjectilePool::view(int first) const noexcept {
+    return ProjectileView(*this, first, count_);
+}
+
+const float* ProjectilePool::posx() const noexcept {
+    return posx_.data();
+}
+
+const float* ProjectilePool::posy() const noexcept {
+    return posy_.data();
+}
+
+const float* ProjectilePool::prevx() const noexcept {
+    return prevx_.data();
+}
+
+const float* ProjectilePool::prevy() const noexcept {
+    return prevy_.data();
+}
+
+const float* ProjectilePool::vx() const noexcept {
+    return vx_.data();
+}
+
+const float* ProjectilePool::vy() const noexcept {
+    return vy_.data();
+}
+
+const unsigned char* ProjectilePool::type() const noexcept {
+    return type_.data();
+}
+
+void ProjectilePool::append(float posx, float posy, float vx, float vy, int type) {
+    // reuse a retired slot if there is one
+    if (count_ < int(posx_.size())) {
+	posx_[count_] = posx;
+	posy_[count_] = posy;
+	prevx_[count_] = posx;
+	prevy_[count_] = posy;
+	vx_[count_] = vx;
+	vy_[count_] = vy;
+	type_[count_] = (unsigned char)(type);
+    }
+    else {
+	posx_.push_back(posx);
+	posy_.push_back(posy);
+	prevx_.push_back(posx);
+	prevy_.push_back(posy);
+	vx_.push_back(vx);
+	vy_.push_back(vy);
+	type_.push_back((unsigned char)(type));
+	offScreen_.push_back(0);
+    }
+    count_++;
+}
+
+int ProjectilePool::extend(int count) {
+    // grow every array at once, past the retired slots, if those
+    // are not enough
+    int first = count_;
+    size_t needed = size_t(first) + count;
+    if (needed > posx_.size()) {
+	posx_.resize(needed);
+	posy_.resize(needed);
+	prevx_.resize(needed);
+	prevy_.resize(needed);
+	vx_.resize(needed);
+	vy_.resize(needed);
+	type_.resize(needed);
+	offScreen_.resize(needed, 0);
+    }
+    count_ += count;
+    return first;
+}
+
+void ProjectilePool::updateWalls() noexcept {
+    // fold each type's radius and behavior into where its projectiles
+    // bounce and where they leave the screen. Projectiles that do not
+    // bounce leave through the sides once the largest of them is
+    // fully off screen, and any projectile can leave through the top
+    // on its way up.
+    int types = ProjectileTypes::size();
+    margin_ = 0.0f;
+    wallTypes_ = types;
+    for (int id = 0; id < types; id++) {
+	const ProjectileType& type = ProjectileTypes::get(id);
+	float radius = float(type.radius);
+	left_[id] = type.bounces ? radius : -numeric_limits<float>::infinity();
+	right_[id] = type.bounces ? float(width_) - radius : numeric_limits<float>::infinity();
+	bottom_[id] = float(height_) + radius;
+	margin_ = max(margin_, radius);
+    }
+}
@@ -0,0 +1,409 @@
+#ifndef SPACEPIG_PROJECTILEPOOL_H
+#define SPACEPIG_PROJECTILEPOOL_H
+
+#include <algorithm>
+#include "Arena.h"
+#include "Projectile.h"
+#include "ProjectileStep.h"
+
+namespace spacePig {
+
+class ProjectilePool;
+
+/**
+ * A read-only handle to one projectile stored in a ProjectilePool.
+ * Mirrors the accessors of Projectile without copying any state.
+ * A handle is only valid until the pool is next modified.
+ */
+class ProjectileRef {
+public:
+    ProjectileRef(/** pool holding the projectile */ const ProjectilePool& pool,
+		/** index of the projectile */ int index) noexcept;
+
+    /**
+     * The x coordinate of the top left of the projectile
+     * @return the x coordinate of the projectile.
+     */
+    int getX() const noexcept;
+
+    /**
+     * The y coordinate of the top left of the projectile
+     * @return the y coordinate of the projectile.
+     */
+    int getY() const noexcept;
+
+    /**
+     * The x coordinate of the top left of the projectile, blended
+     * between its position before and after the last step.
+     * @return the interpolated x coordinate of the projectile.
+     */
+    int getX(/** 0 for the previous position, 1 for the current */ double alpha) const noexcept;
+
+    /**
+     * The y coordinate of the top left of the projectile, blended
+     * between its position before and after the last step.
+     * @return the interpolated y coordinate of the projectile.
+     */
+    int getY(/** 0 for the previous position, 1 for the current */ double alpha) const noexcept;
+
+    /**
+     * The diameter of the projectile
+     * @return the diameter of the projectile.
+     */
+    int getDiameter() const noexcept;
+
+    /**
+     * The exact x coordinate of the center of the projectile
+     * @return the x coordinate of the center
+     */
+    double getCenterX() const noexcept;
+
+    /**
+     * The exact y coordinate of the center of the projectile
+     * @return the y coordinate of the center
+     */
+    double getCenterY() const noexcept;
+
+    /**
+     * The x velocity of the projectile
+     * @return the x velocity
+     */
+    double getVelocityX() const noexcept;
+
+    /**
+     * The y velocity of the projectile
+     * @return the y velocity
+     */
+    double getVelocityY() const noexcept;
+
+    /**
+     * The radius of the projectile
+     * @return the radius of the projectile
+     */
+    double getRadius() const noexcept;
+
+    /**
+     * The id of the projectile's type
+     * @return the type id
+     */
+    int getType() const noexcept;
+
+private:
+    /** pool holding the projectile */
+    const ProjectilePool* pool_;
+
+    /** index of the projectile in the pool */
+    int index_;
+};
+
+/**
+ * A zero-copy, read-only range over the live projectiles of a pool.
+ * Iterating yields ProjectileRef handles, so reading wave state through
+ * a view never allocates. A view is only valid until the pool is next
+ * modified.
+ */
+class ProjectileView {
+public:
+    /**
+     * Forward iterator over the projectiles of a view.
+     */
+    class iterator {
+    public:
+	iterator(const ProjectilePool* pool, int index) noexcept;
+	ProjectileRef operator*() const noexcept;
+	iterator& operator++() noexcept;
+	bool operator!=(const iterator& other) const noexcept;
+	bool operator==(const iterator& other) const noexcept;
+    private:
+	const ProjectilePool* pool_;
+	int index_;
+    };
+
+    ProjectileView(/** pool to view */ const ProjectilePool& pool,
+		/** index of the first projectile in the view */ int first,
+		/** index one past the last projectile in the view */ int last) noexcept;
+
+    /**
+     * The number of projectiles in the view.
+     * @return the projectile count
+     */
+    int size() const noexcept;
+
+    /**
+     * Whether or not the view has any projectiles.
+     * @return true if there are no projectiles
+     */
+    bool empty() const noexcept;
+
+    /**
+     * The projectile at an index.
+     * @return a handle to the projectile
+     */
+    ProjectileRef operator[](/** index of the projectile */ int index) const noexcept;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+    /**
+     * The pool behind the view, for loops that want the raw arrays.
+     * @return the viewed pool
+     */
+    const ProjectilePool& pool() const noexcept;
+
+    /**
+     * The pool index of the first projectile in the view.
+     * @return the index of the first projectile
+     */
+    int first() const noexcept;
+
+private:
+    /** pool being viewed */
+    const ProjectilePool* pool_;
+
+    /** index of the first projectile in the view */
+    int first_;
+
+    /** index one past the last projectile in the view */
+    int last_;
+};
+
+/**
+ * A contiguous structure-of-arrays store for projectiles.
+ * Each attribute of a projectile lives in its own array so that
+ * the per-tick walks over a wave only touch the data they need.
+ * A projectile takes six floats and a type id, 25 bytes in all;
+ * its radius and behavior are shared through ProjectileTypes.
+ * Only the first size() entries of each array are live. Retiring
+ * a projectile swaps the last live one into its slot, so the order
+ * of projectiles in the pool is not preserved.
+ * The arrays can be drawn from an arena, such as one kept for a wave.
+ */
+class ProjectilePool {
+public:
+    /**
+     * Construct an empty pool. The pool must know the bounds
+     * of the window so that its projectiles bounce off the walls.
+     */
+    ProjectilePool(/** width of the screen */ int width = 450,
+		/** height of the screen */ int height = 800,
+		/** arena to store the projectiles in, or null for the heap */
+		Arena* arena = nullptr);
+
+    /**
+     * The number of live projectiles in the pool.
+     * @return the live count
+     */
+    int size() const noexcept;
+
+    /**
+     * Whether or not the pool has any live projectiles.
+     * @return true if there are no live projectiles
+     */
+    bool empty() const noexcept;
+
+    /**
+     * Make room for a number of projectiles without reallocating.
+     */
+    void reserve(/** number of projectiles */ int count);
+
+    /**
+     * Add a projectile to the end of the pool.
+     */
+    void push(/** projectile to add */ const Projectile& proj);
+
+    /**
+     * Add a projectile to the end of the pool from raw state, for
+     * emitters that compute positions and velocities themselves.
+     */
+    void emit(/** x-coordinate */ float posx,
+	    /** y-coordinate */ float posy,
+	    /** x velocity */ float vx,
+	    /** y velocity */ float vy,
+	    /** id of the projectile's type */ int type = ProjectileTypes::standard);
+
+    /**
+     * Add a run of projectiles fired from one point, making room for
+     * all of them at once and filling each array in one pass. Each
+     * projectile is followed by its mirror image if mirrored, fired
+     * from mirrorX and flying the other way across the screen.
+     * velocity(ii, vx, vy) sets the velocity of the iith projectile.
+     */
+    template <class Velocity>
+    void emitRun(/** x-coordinate */ float posx,
+	    /** y-coordinate */ float posy,
+	    /** number of projectiles, not counting mirror images */ int count,
+	    /** id of the projectiles' type */ int type,
+	    /** whether to add mirror images */ bool mirrored,
+	    /** x-coordinate the mirror images are fired from */ float mirrorX,
+	    /** sets each projectile's velocity */ Velocity velocity) {
+	int stride = mirrored ? 2 : 1;
+	int first = extend(count * stride);
+	for (int ii = 0, at = first; ii < count; ii++, at += stride) {
+	    float vx;
+	    float vy;
+	    velocity(ii, vx, vy);
+	    posx_[at] = posx;
+	    posy_[at] = posy;
+	    vx_[at] = vx;
+	    vy_[at] = vy;
+	    if (mirrored) {
+		posx_[at + 1] = mirrorX;
+		posy_[at + 1] = posy;
+		vx_[at + 1] = -vx;
+		vy_[at + 1] = vy;
+	    }
+	}
+	int end = first + count * stride;
+	std::copy(posx_.begin() + first, posx_.begin() + end, prevx_.begin() + first);
+	std::copy(posy_.begin() + first, posy_.begin() + end, prevy_.begin() + first);
+	std::fill(type_.begin() + first, type_.begin() + end, (unsigned char)(type));
+    }
+
+    /**
+     * Remove the projectile at an index by swapping the last live
+     * projectile into its place.
+     */
+    void retire(/** index of the projectile */ int index) noexcept;
+
+    /**
+     * Remove every projectile. The storage is kept for reuse.
+     */
+    void clear() noexcept;
+
+    /**
+     * Retire the projectiles the previous step carried off the screen,
+     * then move every projectile over delta time, bouncing off the
+     * walls. Projectiles that leave the screen stay in the pool until
+     * the next step, so a collision test can still follow them over
+     * the step they left in.
+     */
+    void step(/** The interval of time during which the sprites move. */ double delta) noexcept;
+
+    /**
+     * The time the last step moved the projectiles over.
+     * @return the time, 0 before the first step
+     */
+    float getStepDelta() const noexcept;
+
+    /**
+     * When a projectile bounced off a wall during the last step, so
+     * its path over the step can be followed. A projectile added
+     * since the last step has not moved, and has not bounced.
+     * @return the fraction of the step at which it bounced, or a
+     * negative value if it did not bounce
+     */
+    float getBounceTime(/** index of the projectile */ int index) const noexcept;
+
+    /**
+     * A read-only view of the live projectiles.
+     * @return a view over the pool
+     */
+    ProjectileView view() const noexcept;
+
+    /**
+     * A read-only view of the live projectiles from an index onwards.
+     * @return a view over the tail of the pool
+     */
+    ProjectileView view(/** index of the first projectile */ int first) const noexcept;
+
+    /** x-coordinates of the live projectiles, size() entries long */
+    const float* posx() const noexcept;
+
+    /** y-coordinates of the live projectiles, size() entries long */
+    const float* posy() const noexcept;
+
+    /** x-coordinates before the last step, size() entries long */
+    const float* prevx() const noexcept;
+
+    /** y-coordinates before the last step, size() entries long */
+    const float* prevy() const noexcept;
+
+    /** x velocities of the live projectiles, size() entries long */
+    const float* vx() const noexcept;
+
+    /** y velocities of the live projectiles, size() entries long */
+    const float* vy() const noexcept;
+
+    /** type ids of the live projectiles, size() entries long */
+    const unsigned char* type() const noexcept;
+
+private:
+    /** x-coordinates of the live projectiles */
+    ArenaVector<float> posx_;
+
+    /** y-coordinates of the live projectiles */
+    ArenaVector<float> posy_;
+
+    /** x-coordinates before the last step */
+    ArenaVector<float> prevx_;
+
+    /** y-coordinates before the last step */
+    ArenaVector<float> prevy_;
+
+    /** x velocities of the live projectiles */
+    ArenaVector<float> vx_;
+
+    /** y velocities of the live projectiles */
+    ArenaVector<float> vy_;
+
+    /** type ids of the live projectiles */
+    ArenaVector<unsigned char> type_;
+
+    /** off-screen flags filled in by step() */
+    ArenaVector<unsigned char> offScreen_;
+
+    /** number of live projectiles */
+    int count_ = 0;
+
+    /** number of projectiles the last step moved and flagged */
+    int stepped_ = 0;
+
+    /** time the last step moved the projectiles over */
+    float stepDelta_ = 0.0f;
+
+    /** width of the game display */
+    int width_ = 450;
+
+    /** height of the game display */
+    int height_ = 800;
+
+    /**
+     * per type, the x-coordinate a projectile bounces off on the left.
+     * The wall tables have room for every type that can be registered,
+     * so stepping never allocates.
+     */
+    float left_[ProjectileTypes::capacity];
+
+    /** per type, the x-coordinate a projectile bounces off on the right */
+    float right_[ProjectileTypes::capacity];
+
+    /** per type, the y-coordinate past which a projectile is off screen */
+    float bottom_[ProjectileTypes::capacity];
+
+    /** number of types the wall tables were filled in for */
+    int wallTypes_ = 0;
+
+    /** how far past the sides and top a projectile leaves the screen */
+    float margin_ = 0.0f;
+
+    /**
+     * Rebuild the per-type wall tables from the type registry.
+     */
+    void updateWalls() noexcept;
+
+    /**
+     * Append raw projectile state, reusing retired slots when possible.
+     */
+    void append(float posx, float posy, float vx, float vy, int type);
+
+    /**
+     * Make room for a number of projectiles at the end of the pool,
+     * reusing retired slots when possible, and count them as live.
+     * @return the index of the first of them
+     */
+    int extend(/** number of projectiles */ int count);
+};
+
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include <cstring>
+#include "ProjectileStep.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPACEPIG_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace spacePig;
+
+namespace {
+
+/** signature shared by every kernel */
+typedef void (*StepKernel)(float*, float*, float*, const float*,
+    const unsigned char*, int, float, const StepWalls&, unsigned char*);
+
+#ifdef SPACEPIG_X86_KERNELS
+
+/**
+ * Four projectiles per iteration. The tail is left to the scalar kernel.
+ * @return the number of projectiles handled
+ */
+__attribute__((target("sse2")))
+int stepSse2(float* posx, float* posy, float* vx, const float* vy,
+    const unsigned char* type, int count, float delta, const StepWalls& walls,
+    unsigned char* offScreen) noexcept {
+    const __m128 dt = _mm_set1_ps(delta);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 exitLeft = _mm_set1_ps(walls.exitLeft);
+    const __m128 exitRight = _mm_set1_ps(walls.exitRight);
+    const __m128 exitTop = _mm_set1_ps(walls.exitTop);
+    const float* left = walls.left;
+    const float* right = walls.right;
+    const float* bottom = walls.bottom;
+
+    int ii = 0;
+    for (; ii + 4 <= count; ii += 4) {
+	const unsigned char* t = type + ii;
+	__m128 l = _mm_set_ps(left[t[3]], left[t[2]], left[t[1]], left[t[0]]);
+	__m128 r = _mm_set_ps(right[t[3]], right[t[2]], right[t[1]], right[t[0]]);
+	__m128 b = _mm_set_ps(bottom[t[3]], bottom[t[2]], bottom[t[1]], bottom[t[0]]);
+	__m128 x = _mm_loadu_ps(posx + ii);
+	__m128 y = _mm_loadu_ps(posy + ii);
+	__m128 u = _mm_loadu_ps(vx + ii);
+	__m128 v = _mm_loadu_ps(vy + ii);
+
+	x = _mm_add_ps(x, _mm_mul_ps(dt, u));
+	y = _mm_add_ps(y, _mm_mul_ps(dt, v));
+
+	// Bounce against the left wall
+	__m128 hit = _mm_cmplt_ps(x, l);
+	__m128 bounced = _mm_sub_ps(_mm_mul_ps(two, l), x);
+	x = _mm_or_ps(_mm_and_ps(hit, bounced), _mm_andnot_ps(hit, x));
+	u = _mm_xor_ps(u, _mm_and_ps(hit, sign));
+
+	// then against the right wall
+	hit = _mm_cmpgt_ps(x, r);
+	bounced = _mm_sub_ps(_mm_mul_ps(two, r), x);
+	x = _mm_or_ps(_mm_and_ps(hit, bounced), _mm_andnot_ps(hit, x));
+	u = _mm_xor_ps(u, _mm_and_ps(hit, sign));
+
+	_mm_storeu_ps(posx + ii, x);
+	_mm_storeu_ps(posy + ii, y);
+	_mm_storeu_ps(vx + ii, u);
+
+	__m128 gone = _mm_or_ps(_mm_cmpgt_ps(y, b),
+	    _mm_or_ps(_mm_cmplt_ps(x, exitLeft), _mm_cmpgt_ps(x, exitRight)));
+	gone = _mm_or_ps(gone, _mm_and_ps(_mm_cmplt_ps(y, exitTop), _mm_cmplt_ps(v, zero)));
+	int off = _mm_movemask_ps(gone);
+	for (int lane = 0; lane < 4; lane++) {
+	    offScreen[ii + lane] = (off >> lane) & 1;
+	}
+    }
+    return ii;
+}
+
+/**
+ * Eight projectiles per iteration. The tail is left to the scalar kernel.
+ * @return the number of projectiles handled
+ */
+__attribute__((target("avx")))
+int stepAvx(float* posx, float* posy, float* vx, const float* vy,
+    const unsigned char* type, int count, float delta, const StepWalls& walls,
+    unsigned char* offScreen) noexcept {
+    const __m256 dt = _mm256_set1_ps(delta);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 exitLeft = _mm256_set1_ps(walls.exitLeft);
+    const __m256 exitRight = _mm256_set1_ps(walls.exitRight);
+    const __m256 exitTop = _mm256_set1_ps(walls.exitTop);
+    const float* left = walls.left;
+    const float* right = walls.right;
+    const float* bottom = walls.bottom;
+
+    int ii = 0;
+    for (; ii + 8 <= count; ii += 8) {
+	const unsigned char* t = type + ii;
+	__m256 l = _mm256_set_ps(left[t[7]], left[t[6]], left[t[5]], left[t[4]],
+	    left[t[3]], left[t[2]], left[t[1]], left[t[0]]);
+	__m256 r = _mm256_set_ps(right[t[7]], right[t[6]], right[t[5]], right[t[4]],
+	    right[t[3]], right[t[2]], right[t[1]], right[t[0]]);
+	__m256 b = _mm256_set_ps(bottom[t[7]], bottom[t[6]], bottom[t[5]], bottom[t[4]],
+	    bottom[t[3]], bottom[t[2]], bottom[t[1]], bottom[t[0]]);
+	__m256 x = _mm256_loadu_ps(posx + ii);
+	__m256 y = _mm256_loadu_ps(posy + ii);
+	__m256 u = _mm256_loadu_ps(vx + ii);
+	__m256 v = _mm256_loadu_ps(vy + ii);
+
+	x = _mm256_add_ps(x, _mm256_mul_ps(dt, u));
+	y = _mm256_add_ps(y, _mm256_mul_ps(dt, v));
+
+	// Bounce against the left wall
+	__m256 hit = _mm256_cmp_ps(x, l, _CMP_LT_OQ);
+	x = _mm256_blendv_ps(x, _mm256_sub_ps(_mm256_mul_ps(two, l), x), hit);
+	u = _mm256_xor_ps(u, _mm256_and_ps(hit, sign));
+
+	// then against the right wall
+	hit = _mm256_cmp_ps(x, r, _CMP_GT_OQ);
+	x = _mm256_blendv_ps(x, _mm256_sub_ps(_mm256_mul_ps(two, r), x), hit);
+	u = _mm256_xor_ps(u, _mm256_and_ps(hit, sign));
+
+	_mm256_storeu_ps(posx + ii, x);
+	_mm256_storeu_ps(posy + ii, y);
+	_mm256_storeu_ps(vx + ii, u);
+
+	__m256 gone = _mm256_or_ps(_mm256_cmp_ps(y, b, _CMP_GT_OQ),
+	    _mm256_or_ps(_mm256_cmp_ps(x, exitLeft, _CMP_LT_OQ),
+		_mm256_cmp_ps(x, exitRight, _CMP_GT_OQ)));
+	gone = _mm256_or_ps(gone, _mm256_and_ps(_mm256_cmp_ps(y, exitTop, _CMP_LT_OQ),
+	    _mm256_cmp_ps(v, zero, _CMP_LT_OQ)));
+	int off = _mm256_movemask_ps(gone);
+	for (int lane = 0; lane < 8; lane++) {
+	    offScreen[ii + lane] = (off >> lane) & 1;
+	}
+    }
+    return ii;
+}
+
+void stepSse2Kernel(float* posx, float* posy, float* vx, const float* vy,
+    const unsigned char* type, int count, float delta, const StepWalls& walls,
+    unsigned char* offScreen) noexcept {
+    int done = stepSse2(posx, posy, vx, vy, type, count, delta, walls, offScreen);
+    stepProjectilesScalar(posx + done, posy + done, vx + done, vy + done,
+	type + done, count - done, delta, walls, offScreen + done);
+}
+
+void stepAvxKernel(float* posx, float* posy, float* vx, const float* vy,
+    const unsigned char* type, int count, float delta, const StepWalls& walls,
+    unsigned char* offScreen) noexcept {
+    int done = stepAvx(posx, posy, vx, vy, type, count, delta, walls, offScreen);
+    stepProjectilesScalar(posx + done, posy + done, vx + done, vy + done,
+	type + done, count - done, delta, walls, offScreen + done);
+}
+
+#endif
+
+/** name of the kernel that was picked */
+const char* kernelName = "scalar";
+
+/**
+ * Pick the widest kernel the CPU supports.
+ * @return the chosen kernel
+ */
+StepKernel chooseKernel() noexcept {
+#ifdef SPACEPIG_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+	kernelName = "avx";
+	return stepAvxKernel;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+	kernelName = "sse2";
+	return stepSse2Kernel;
+    }
+#endif
+    kernelName = "scalar";
+    return stepProjectilesScalar;
+}
+
+/** a kernel picked by useStepKernel, overriding the CPU's choice */
+StepKernel forced = nullptr;
+
+/** name of the forced kernel */
+const char* forcedName = nullptr;
+
+/**
+ * The kernel to dispatch to, chosen on first use.
+ * @return the chosen kernel
+ */
+StepKernel kernel() noexcept {
+    static const StepKernel chosen = chooseKernel();
+    return forced ? forced : chosen;
+}
+
+}
+
+void spacePig::stepProjectilesScalar(float* posx, float* posy, float* vx,
+    const float* vy, const unsigned char* type, int count, float delta,
+    const StepWalls& walls, unsigned char* offScreen) noexcept {
+    for (int ii = 0; ii < count; ii++) {
+	float l = walls.left[type[ii]];
+	float r = walls.right[type[ii]];
+	posx[ii] += delta * vx[ii];
+	posy[ii] += delta * vy[ii];
+	// Bounce against walls
+	if (posx[ii] < l) {
+	    posx[ii] = 2.0f * l - posx[ii];
+	    vx[ii] = -vx[ii];
+	}
+
+	if (posx[ii] > r) {
+	    posx[ii] = 2.0f * r - posx[ii];
+	    vx[ii] = -vx[ii];
+	}
+
+	offScreen[ii] = posy[ii] > walls.bottom[type[ii]]
+	    || posx[ii] < walls.exitLeft || posx[ii] > walls.exitRight
+	    || (posy[ii] < walls.exitTop && vy[ii] < 0.0f);
+    }
+}
+
+void spacePig::stepProjectiles(float* posx, float* posy, float* vx,
+    const float* vy, const unsigned char* type, int count, float delta,
+    const StepWalls& walls, unsigned char* offScreen) noexcept {
+    kernel()(posx, posy, vx, vy, type, count, delta, walls, offScreen);
+}
+
+bool spacePig::useStepKernel(const char* name) noexcept {
+    if (strcmp(name, "scalar") == 0) {
+	forced = stepProjectilesScalar;
+	forcedName = "scalar";
+	return true;
+    }
+#ifdef SPACEPIG_X86_KERNELS
+    __builtin_cpu_init();
+    if (strcmp(name, "avx") == 0 && __builtin_cpu_supports("avx")) {
+	forced = stepAvxKernel;
+	forcedName = "avx";
+	return true;
+    }
+    if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+	forced = stepSse2Kernel;
+	forcedName = "sse2";
+	return true;
+    }
+#endif
+    return false;
+}
+
+const char* spacePig::stepKernelName() noexcept {
+    kernel();
+    return forced ? forcedName : kernelName;
+}
@@ -0,0 +1,76 @@
+#ifndef SPACEPIG_PROJECTILESTEP_H
+#define SPACEPIG_PROJECTILESTEP_H
+
+namespace spacePig {
+
+/**
+ * Where projectiles bounce and where they leave the screen. The
+ * first three tables are indexed by type id; the exits apply to
+ * every type.
+ */
+struct StepWalls {
+    /** per type, the x-coordinate projectiles bounce off on the left */
+    const float* left;
+
+    /** per type, the x-coordinate projectiles bounce off on the right */
+    const float* right;
+
+    /** per type, the y-coordinate past which projectiles are off screen */
+    const float* bottom;
+
+    /** projectiles left of this are off screen */
+    float exitLeft;
+
+    /** projectiles right of this are off screen */
+    float exitRight;
+
+    /** projectiles above this and moving up are off screen */
+    float exitTop;
+};
+
+/**
+ * Batch integration kernels for projectile motion.
+ * Each kernel moves count projectiles over delta time and reflects
+ * them off the left and right walls of their type, then sets
+ * offScreen[i] to 1 for every projectile that has left the screen
+ * (0 otherwise). Every kernel gives exactly the results of
+ * stepProjectilesScalar.
+ *
+ * stepProjectiles picks the widest kernel the CPU supports the first
+ * time it is called.
+ */
+void stepProjectiles(/** x-coordinates */ float* posx,
+		/** y-coordinates */ float* posy,
+		/** x velocities */ float* vx,
+		/** y velocities */ const float* vy,
+		/** type ids */ const unsigned char* type,
+		/** number of projectiles */ int count,
+		/** time */ float delta,
+		/** where projectiles bounce and leave */ const StepWalls& walls,
+		/** off-screen flags out */ unsigned char* offScreen) noexcept;
+
+/**
+ * The portable one-projectile-at-a-time kernel.
+ */
+void stepProjectilesScalar(float* posx, float* posy, float* vx,
+		const float* vy, const unsigned char* type, int count, float delta,
+		const StepWalls& walls, unsigned char* offScreen) noexcept;
+
+/**
+ * Make stepProjectiles dispatch to a kernel by name rather than the
+ * widest one the CPU supports, so each kernel can be tested. Call it
+ * before any thread steps projectiles.
+ * @return false if the build or the CPU lacks that kernel
+ */
+bool useStepKernel(/** "avx", "sse2" or "scalar" */ const char* name) noexcept;
+
+/**
+ * The name of the kernel stepProjectiles dispatches to:
+ * "avx", "sse2" or "scalar".
+ * @return the kernel name
+ */
+const char* stepKernelName() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include <stdexcept>
+#include <vector>
+#include "ProjectileType.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/**
+ * The registered types, starting with the standard projectile.
+ * @return the registry
+ */
+vector<ProjectileType>& registry() {
+    static vector<ProjectileType> types(1);
+    return types;
+}
+
+}
+
+int ProjectileTypes::add(const ProjectileType& type) {
+    vector<ProjectileType>& types = registry();
+    if (int(types.size()) >= capacity) {
+	throw length_error("Too many projectile types");
+    }
+    types.push_back(type);
+    return int(types.size()) - 1;
+}
+
+const ProjectileType& ProjectileTypes::get(int id) noexcept {
+    return registry()[id];
+}
+
+int ProjectileTypes::size() noexcept {
+    return int(registry().size());
+}
@@ -0,0 +1,61 @@
+#ifndef SPACEPIG_PROJECTILETYPE_H
+#define SPACEPIG_PROJECTILETYPE_H
+
+#include <string>
+
+namespace spacePig {
+
+/**
+ * Everything that projectiles of one kind have in common. Each
+ * projectile only records its position, velocity and the id of its
+ * type; the rest is looked up here.
+ */
+struct ProjectileType {
+    /** the file location of the projectile image */
+    std::string fileLocation = "graphics/projectile.png";
+
+    /** the radius of the projectile image */
+    double radius = 5.0;
+
+    /** whether the projectile bounces off the left and right walls */
+    bool bounces = true;
+};
+
+/**
+ * The registry of projectile types, shared by every wave. Type 0
+ * is the original projectile and is always registered.
+ *
+ * Register types before any session starts: lookups are not
+ * synchronized with registration.
+ */
+class ProjectileTypes {
+public:
+    /** most types that can be registered, since ids are one byte */
+    static const int capacity = 256;
+
+    /** id of the original projectile */
+    static const int standard = 0;
+
+    /**
+     * Add a type to the registry.
+     * @return the id of the new type
+     * @throw length_error if the registry is full.
+     */
+    static int add(/** the type to add */ const ProjectileType& type);
+
+    /**
+     * The type with an id.
+     * @return the type
+     */
+    static const ProjectileType& get(/** id of the type */ int id) noexcept;
+
+    /**
+     * The number of registered types. Ids run from 0 to size() - 1.
+     * @return the type count
+     */
+    static int size() noexcept;
+};
+
+}
+
+#endif
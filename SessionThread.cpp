@@ -0,0 +1,204 @@
+#include <chrono>
+#include <iostream>
+#include <system_error>
+#include "AllocationCounter.h"
+#include "SessionThread.h"
+
+using namespace std;
+using namespace spacePig;
+
+SessionThread::SessionThread(GameSession& session) :
+    session_(session),
+    clock_(session.getTickRate()) {
+    // room for every command a few frames could queue, so queueing
+    // does not allocate
+    queued_.reserve(64);
+    running_.reserve(64);
+}
+
+SessionThread::~SessionThread() {
+    stop();
+}
+
+bool SessionThread::start() noexcept {
+    if (thread_.joinable()) {
+	return true;
+    }
+    session_.setProfiler(&profiler_);
+    stopping_ = false;
+    publish();
+    try {
+	thread_ = thread(&SessionThread::run, this);
+    }
+    catch (const system_error&) {
+	return false;
+    }
+    return true;
+}
+
+void SessionThread::stop() noexcept {
+    if (!thread_.joinable()) {
+	return;
+    }
+    {
+	lock_guard<mutex> guard(lock_);
+	stopping_ = true;
+	queued_.clear();
+    }
+    wake_.notify_all();
+    thread_.join();
+    appliedCount_ = queuedCount_;
+}
+
+bool SessionThread::isRunning() const noexcept {
+    return thread_.joinable();
+}
+
+void SessionThread::steerPlayer(unsigned directions) noexcept {
+    queue(Command{ Command::Steer, int(directions), 0 });
+}
+
+void SessionThread::movePlayerTo(int x, int y) noexcept {
+    queue(Command{ Command::MoveTo, x, y });
+}
+
+void SessionThread::restart() noexcept {
+    queue(Command{ Command::Restart, 0, 0 });
+}
+
+void SessionThread::startNextWave() noexcept {
+    queue(Command{ Command::NextWave, 0, 0 });
+}
+
+void SessionThread::setProfiling(bool profiling) noexcept {
+    queue(Command{ Command::Profile, profiling ? 1 : 0, 0 });
+}
+
+void SessionThread::queue(const Command& command) noexcept {
+    if (!thread_.joinable()) {
+	// nothing else is touching the session
+	apply(command);
+	return;
+    }
+    {
+	lock_guard<mutex> guard(lock_);
+	queued_.push_back(command);
+	queuedCount_++;
+    }
+    wake_.notify_one();
+}
+
+void SessionThread::flush() noexcept {
+    unique_lock<mutex> guard(lock_);
+    unsigned long long target = queuedCount_;
+    applied_.wait(guard, [this, target] { return appliedCount_ >= target || stopping_; });
+}
+
+bool SessionThread::update() noexcept {
+    if (!thread_.joinable()) {
+	publish();
+    }
+    return snapshots_.update();
+}
+
+const GameSnapshot& SessionThread::latest() const noexcept {
+    return snapshots_.front();
+}
+
+double SessionThread::stepSeconds() const noexcept {
+    return clock_.stepSeconds();
+}
+
+void SessionThread::apply(const Command& command) noexcept {
+    switch (command.kind) {
+	case Command::Steer: session_.steerPlayer(unsigned(command.a)); break;
+	case Command::MoveTo: session_.movePlayerTo(command.a, command.b); break;
+	case Command::Restart: session_.restart(); break;
+	case Command::NextWave: session_.startNextWave(); break;
+	case Command::Profile: profiler_.setKeepTotals(command.a != 0); break;
+    }
+}
+
+void SessionThread::publish() noexcept {
+    GameSnapshot& snapshot = snapshots_.back();
+    snapshot.capture(session_);
+    snapshot.alpha = clock_.alpha();
+    snapshot.simulationMs = profiler_.getTotal(FrameProfiler::Simulation);
+    snapshot.collisionMs = profiler_.getTotal(FrameProfiler::Collision);
+    snapshots_.publish();
+}
+
+void SessionThread::run() noexcept {
+    auto last = chrono::steady_clock::now();
+    unsigned long long rounds = 0;
+    unsigned long long allocatingRounds = 0;
+    unique_lock<mutex> guard(lock_);
+    while (!stopping_) {
+	unsigned long long allocations = allocationCount();
+
+	// take the commands queued so far, leaving an empty queue behind
+	running_.swap(queued_);
+	unsigned long long taken = queuedCount_;
+	guard.unlock();
+
+	// the state before the commands decides how time is paid out,
+	// so time spent waiting for a restart is not simulated
+	GameSession::State state = session_.getState();
+	for (const Command& command : running_) {
+	    apply(command);
+	}
+	running_.clear();
+
+	/**
+	 * Advance the session in fixed steps paid out by clock_. Idle
+	 * time between waves is caught up in full, since stepping an
+	 * empty screen is free; time spent waiting to start is not
+	 * simulated at all.
+	 */
+	auto now = chrono::steady_clock::now();
+	double elapsed = chrono::duration<double>(now - last).count();
+	last = now;
+	if (state == GameSession::State::Playing) {
+	    int steps = clock_.advance(elapsed);
+	    for (int ii = 0; ii < steps; ii++) {
+		session_.step();
+	    }
+	}
+	else if (state == GameSession::State::Intermission) {
+	    int steps = clock_.advanceUncapped(elapsed);
+	    for (int ii = 0; ii < steps &&
+		session_.getState() == GameSession::State::Intermission; ii++) {
+		session_.step();
+	    }
+	}
+	else {
+	    clock_.reset();
+	}
+	publish();
+
+	// with allocations counted, keep track of the rounds that made any
+	rounds++;
+	if (countingAllocations() && allocationCount() > allocations) {
+	    allocatingRounds++;
+	}
+
+	// sleep until the next step is due, or for good while nothing
+	// moves, unless a command or a stop arrives first
+	guard.lock();
+	appliedCount_ = taken;
+	applied_.notify_all();
+	state = session_.getState();
+	auto woken = [this] { return stopping_ || !queued_.empty(); };
+	if (state == GameSession::State::Playing ||
+	    state == GameSession::State::Intermission) {
+	    double wait = (1.0 - clock_.alpha()) * clock_.stepSeconds();
+	    wake_.wait_for(guard, chrono::duration<double>(wait), woken);
+	}
+	else {
+	    wake_.wait(guard, woken);
+	}
+    }
+    if (countingAllocations()) {
+	cerr << allocatingRounds << " of " << rounds << " simulation rounds allocated" << endl;
+    }
+}
@@ -0,0 +1,192 @@
+#ifndef SPACEPIG_SESSIONTHREAD_H
+#define SPACEPIG_SESSIONTHREAD_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FrameProfiler.h"
+#include "GameSession.h"
+#include "GameSnapshot.h"
+#include "SimClock.h"
+#include "TripleBuffer.h"
+
+namespace spacePig {
+
+/**
+ * Runs a GameSession on a thread of its own, stepping it in real time
+ * so the simulation never waits on the display. Commands from the
+ * player are queued and applied before the next step. After every
+ * round of steps the thread publishes a GameSnapshot through a triple
+ * buffer, which the display reads without locking and without ever
+ * holding up the simulation.
+ *
+ * While the thread runs, only it may touch the session; everyone else
+ * goes through the commands and the snapshots.
+ */
+class SessionThread {
+public:
+    /**
+     * Construct a runner for a session, which must outlive it.
+     * No thread is started until start().
+     */
+    explicit SessionThread(/** the session to run */ GameSession& session);
+
+    /**
+     * Stop the thread, if it is running.
+     */
+    ~SessionThread();
+
+    SessionThread(const SessionThread&) = delete;
+    SessionThread& operator=(const SessionThread&) = delete;
+
+    /**
+     * Start running the session, unless it is already running.
+     * @return false if no thread could be started
+     */
+    bool start() noexcept;
+
+    /**
+     * Stop running the session and wait for the thread to finish.
+     * Commands not yet applied are dropped.
+     */
+    void stop() noexcept;
+
+    /**
+     * Whether or not the thread is running.
+     * @return true if the session is being run
+     */
+    bool isRunning() const noexcept;
+
+    /**
+     * Hold the player's controls in a set of directions.
+     */
+    void steerPlayer(/** Player::Direction flags held down */ unsigned directions) noexcept;
+
+    /**
+     * Move the player to a point.
+     */
+    void movePlayerTo(/** x-coordinate */ int x, /** y-coordinate */ int y) noexcept;
+
+    /**
+     * Start a new game from the first wave.
+     */
+    void restart() noexcept;
+
+    /**
+     * Begin the next wave right away.
+     */
+    void startNextWave() noexcept;
+
+    /**
+     * Start or stop timing the session's steps. While on, snapshots
+     * carry running totals of the time spent simulating and checking
+     * collisions; while off, the default, the steps are not timed at all.
+     */
+    void setProfiling(/** whether to time the steps */ bool profiling) noexcept;
+
+    /**
+     * Wait until every command queued so far has been applied and a
+     * snapshot showing it has been published. Returns at once if the
+     * thread is not running.
+     */
+    void flush() noexcept;
+
+    /**
+     * Pick up the latest snapshot, if one was published since the
+     * last call. While the thread is not running, capture one from
+     * the session on the calling thread instead.
+     * @return true if there was a new snapshot
+     */
+    bool update() noexcept;
+
+    /**
+     * The snapshot last picked up by update().
+     * @return the snapshot
+     */
+    const GameSnapshot& latest() const noexcept;
+
+    /**
+     * The real time covered by one simulation step.
+     * @return the step length in seconds
+     */
+    double stepSeconds() const noexcept;
+
+private:
+    /** One queued command */
+    struct Command {
+	enum Kind { Steer, MoveTo, Restart, NextWave, Profile };
+
+	/** what to do */
+	Kind kind;
+
+	/** directions for Steer, x-coordinate for MoveTo, 1 or 0 for Profile */
+	int a;
+
+	/** y-coordinate for MoveTo */
+	int b;
+    };
+
+    /** the session being run */
+    GameSession& session_;
+
+    /** fixed-step clock pacing the session's steps */
+    SimClock clock_;
+
+    /** times the session's phases on the thread, while profiling */
+    FrameProfiler profiler_;
+
+    /** snapshots on their way to the display */
+    TripleBuffer<GameSnapshot> snapshots_;
+
+    /** the thread running the session */
+    std::thread thread_;
+
+    /** guards everything below */
+    std::mutex lock_;
+
+    /** signalled when a command is queued or the thread should stop */
+    std::condition_variable wake_;
+
+    /** signalled when a round of commands has been applied */
+    std::condition_variable applied_;
+
+    /** commands waiting for the thread */
+    std::vector<Command> queued_;
+
+    /** commands being applied, swapped with queued_ so neither reallocates */
+    std::vector<Command> running_;
+
+    /** number of commands queued so far */
+    unsigned long long queuedCount_ = 0;
+
+    /** number of commands applied and published so far */
+    unsigned long long appliedCount_ = 0;
+
+    /** whether the thread should exit */
+    bool stopping_ = false;
+
+    /**
+     * Queue a command and wake the thread.
+     */
+    void queue(/** the command */ const Command& command) noexcept;
+
+    /**
+     * Apply a command to the session.
+     */
+    void apply(/** the command */ const Command& command) noexcept;
+
+    /**
+     * Capture the session into the back snapshot and publish it.
+     */
+    void publish() noexcept;
+
+    /**
+     * The body of the thread.
+     */
+    void run() noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "SimClock.h"
+
+using namespace spacePig;
+
+SimClock::SimClock(double tickRate, int maxCatchUp) :
+    step_(1.0 / tickRate),
+    maxCatchUp_(maxCatchUp)
+    {}
+
+int SimClock::advance(double elapsed) noexcept {
+    accumulator_ += elapsed;
+    int steps = int(accumulator_ / step_);
+
+    // drop whatever the cap does not let us catch up on
+    if (steps > maxCatchUp_) {
+	steps = maxCatchUp_;
+	accumulator_ = 0.0;
+    }
+    else {
+	accumulator_ -= steps * step_;
+    }
+    return steps;
+}
+
+int SimClock::advanceUncapped(double elapsed) noexcept {
+    accumulator_ += elapsed;
+    int steps = int(accumulator_ / step_);
+    accumulator_ -= steps * step_;
+    return steps;
+}
+
+double SimClock::alpha() const noexcept {
+    return accumulator_ / step_;
+}
+
+void SimClock::reset() noexcept {
+    accumulator_ = 0.0;
+}
+
+double SimClock::getTickRate() const noexcept {
+    return 1.0 / step_;
+}
+
+void SimClock::setTickRate(double tickRate) noexcept {
+    step_ = 1.0 / tickRate;
+}
+
+double SimClock::stepSeconds() const noexcept {
+    return step_;
+}
@@ -0,0 +1,80 @@
+#ifndef SPACEPIG_SIMCLOCK_H
+#define SPACEPIG_SIMCLOCK_H
+
+namespace spacePig {
+
+/**
+ * A fixed-timestep simulation clock.
+ * Real time between frames is fed into an accumulator, which is paid
+ * out in whole simulation steps of 1 / tickRate seconds. The time left
+ * over is exposed as an interpolation factor so a frame can be drawn
+ * between the last two simulation states. The number of steps paid out
+ * per frame is capped so that a long stall does not have to be caught
+ * up all at once.
+ */
+class SimClock {
+public:
+    /**
+     * Construct a clock with an empty accumulator.
+     */
+    SimClock(/** simulation steps per second */ double tickRate = 60.0,
+	    /** most steps paid out per frame */ int maxCatchUp = 5);
+
+    /**
+     * Add real time to the accumulator and take out the steps that
+     * have come due. Time beyond the catch-up cap is dropped.
+     * @return the number of simulation steps to run
+     */
+    int advance(/** real seconds since the last call */ double elapsed) noexcept;
+
+    /**
+     * Add real time to the accumulator and take out every step that
+     * has come due, ignoring the catch-up cap. Meant for idle periods
+     * where steps are cheap.
+     * @return the number of simulation steps to run
+     */
+    int advanceUncapped(/** real seconds since the last call */ double elapsed) noexcept;
+
+    /**
+     * How far between the previous and current simulation states the
+     * leftover time reaches.
+     * @return a fraction in [0, 1)
+     */
+    double alpha() const noexcept;
+
+    /**
+     * Empty the accumulator, for example after an idle period.
+     */
+    void reset() noexcept;
+
+    /**
+     * The number of simulation steps per second.
+     * @return the tick rate
+     */
+    double getTickRate() const noexcept;
+
+    /**
+     * Change the number of simulation steps per second.
+     */
+    void setTickRate(/** simulation steps per second */ double tickRate) noexcept;
+
+    /**
+     * The real time covered by one simulation step.
+     * @return the step length in seconds
+     */
+    double stepSeconds() const noexcept;
+
+private:
+    /** real seconds covered by one step */
+    double step_ = 1.0 / 60.0;
+
+    /** most steps paid out per frame */
+    int maxCatchUp_ = 5;
+
+    /** real seconds not yet paid out as steps */
+    double accumulator_ = 0.0;
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "SpriteBatch.h"
+
+using namespace std;
+using namespace spacePig;
+
+void SpriteBatch::clear() noexcept {
+    for (int ii = 0; ii < used_; ii++) {
+	buckets_[ii].vertices.clear();
+	buckets_[ii].indices.clear();
+    }
+    used_ = 0;
+}
+
+void SpriteBatch::begin(Arena& arena, int quads) {
+    clear();
+    arena_ = &arena;
+    quads_ = quads;
+}
+
+void SpriteBatch::add(SDL_Texture* texture, const SDL_Rect& destination,
+    const SDL_FRect& source) {
+    // find the bucket for this texture, there are only ever a few
+    int bb = 0;
+    while (bb < used_ && buckets_[bb].texture != texture) {
+	bb++;
+    }
+    if (bb == used_) {
+	if (used_ == int(buckets_.size())) {
+	    buckets_.push_back(Bucket());
+	}
+	Bucket& fresh = buckets_[used_++];
+	fresh.texture = texture;
+	if (arena_) {
+	    // last frame's buffers went back with the arena's reset
+	    fresh.vertices = ArenaVector<SDL_Vertex>(ArenaAllocator<SDL_Vertex>(arena_));
+	    fresh.indices = ArenaVector<int>(ArenaAllocator<int>(arena_));
+	    fresh.vertices.reserve(4 * quads_);
+	    fresh.indices.reserve(6 * quads_);
+	}
+    }
+    Bucket& bucket = buckets_[bb];
+
+    float left = float(destination.x);
+    float top = float(destination.y);
+    float right = float(destination.x + destination.w);
+    float bottom = float(destination.y + destination.h);
+    float u0 = source.x;
+    float v0 = source.y;
+    float u1 = source.x + source.w;
+    float v1 = source.y + source.h;
+    const SDL_Color white = { 0xff, 0xff, 0xff, 0xff };
+
+    int first = int(bucket.vertices.size());
+    bucket.vertices.push_back(SDL_Vertex{ { left, top }, white, { u0, v0 } });
+    bucket.vertices.push_back(SDL_Vertex{ { right, top }, white, { u1, v0 } });
+    bucket.vertices.push_back(SDL_Vertex{ { right, bottom }, white, { u1, v1 } });
+    bucket.vertices.push_back(SDL_Vertex{ { left, bottom }, white, { u0, v1 } });
+
+    const int corners[] = { 0, 1, 2, 0, 2, 3 };
+    for (int corner : corners) {
+	bucket.indices.push_back(first + corner);
+    }
+}
+
+int SpriteBatch::draw(SDL_Renderer* renderer) {
+    int status = 0;
+    for (int ii = 0; ii < used_ && status == 0; ii++) {
+	Bucket& bucket = buckets_[ii];
+	if (!bucket.vertices.empty()) {
+	    status = SDL_RenderGeometry(renderer, bucket.texture,
+		bucket.vertices.data(), int(bucket.vertices.size()),
+		bucket.indices.data(), int(bucket.indices.size()));
+	}
+    }
+    clear();
+    return status;
+}
+
+int SpriteBatch::size() const noexcept {
+    int quads = 0;
+    for (int ii = 0; ii < used_; ii++) {
+	quads += int(buckets_[ii].vertices.size()) / 4;
+    }
+    return quads;
+}
@@ -0,0 +1,82 @@
+#ifndef SPACEPIG_SPRITEBATCH_H
+#define SPACEPIG_SPRITEBATCH_H
+
+#include <SDL.h>
+#include <vector>
+#include "Arena.h"
+
+namespace spacePig {
+
+/**
+ * Collects textured quads for a frame and submits them with one
+ * SDL_RenderGeometry call per texture, instead of one copy per sprite.
+ * Quads are drawn in the order their textures were first added, and
+ * in the order they were added within a texture. The vertex and index
+ * buffers keep their storage from frame to frame, or are taken from a
+ * per-frame arena when one is given to begin().
+ * Requires SDL 2.0.18 or later.
+ */
+class SpriteBatch {
+public:
+    /**
+     * Start a frame, taking the vertex and index buffers from an arena
+     * that is reset between frames. The batch must be drawn or cleared
+     * before the arena is next reset.
+     */
+    void begin(/** the frame's arena */ Arena& arena,
+	    /** quads expected this frame, room is made for them up front */ int quads);
+
+    /**
+     * Drop every quad collected so far, keeping the storage.
+     */
+    void clear() noexcept;
+
+    /**
+     * Queue one axis-aligned sprite.
+     */
+    void add(/** texture to draw from */ SDL_Texture* texture,
+	    /** where to draw on screen */ const SDL_Rect& destination,
+	    /** normalized texture coordinates to draw */ 
+	    const SDL_FRect& source = SDL_FRect{ 0.0f, 0.0f, 1.0f, 1.0f });
+
+    /**
+     * Submit every queued sprite, one call per texture, then clear.
+     * @return 0 on success, or a negative SDL error code
+     */
+    int draw(/** renderer to draw with */ SDL_Renderer* renderer);
+
+    /**
+     * The number of quads queued.
+     * @return the quad count
+     */
+    int size() const noexcept;
+
+private:
+    /** The quads queued for one texture */
+    struct Bucket {
+	/** texture the quads sample */
+	SDL_Texture* texture;
+
+	/** four corners per quad */
+	ArenaVector<SDL_Vertex> vertices;
+
+	/** two triangles per quad */
+	ArenaVector<int> indices;
+    };
+
+    /** a bucket per texture used this frame, plus spares for reuse */
+    std::vector<Bucket> buckets_;
+
+    /** number of buckets in use this frame */
+    int used_ = 0;
+
+    /** the frame's arena, or null to keep buffers on the heap */
+    Arena* arena_ = nullptr;
+
+    /** quads expected this frame */
+    int quads_ = 0;
+};
+
+}
+
+#endif
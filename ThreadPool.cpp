@@ -0,0 +1,121 @@
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** the pool the current thread works for, if any */
+thread_local const ThreadPool* currentPool = nullptr;
+
+/** the index of the current thread in its pool */
+thread_local int currentWorker = -1;
+
+}
+
+ThreadPool::ThreadPool(int threads) :
+    queued_(0),
+    unfinished_(0),
+    nextQueue_(0) {
+    if (threads <= 0) {
+	threads = int(thread::hardware_concurrency());
+    }
+    if (threads <= 0) {
+	threads = 1;
+    }
+
+    for (int ii = 0; ii < threads; ii++) {
+	queues_.push_back(unique_ptr<Queue>(new Queue()));
+    }
+    for (int ii = 0; ii < threads; ii++) {
+	threads_.push_back(thread(&ThreadPool::run, this, ii));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+	lock_guard<mutex> guard(idleLock_);
+	stopping_ = true;
+    }
+    wake_.notify_all();
+    for (thread& worker : threads_) {
+	worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    // keep work submitted by a task local to its worker
+    int target = currentPool == this ? currentWorker 
+	: int(nextQueue_++ % queues_.size());
+    unfinished_++;
+    {
+	lock_guard<mutex> guard(queues_[target]->lock);
+	queues_[target]->tasks.push_back(move(task));
+    }
+    {
+	lock_guard<mutex> guard(idleLock_);
+	queued_++;
+    }
+    wake_.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> guard(idleLock_);
+    done_.wait(guard, [this] { return unfinished_ == 0; });
+}
+
+int ThreadPool::size() const noexcept {
+    return int(threads_.size());
+}
+
+bool ThreadPool::take(int self, function<void()>& task) {
+    // newest task from our own queue first, while it is still in cache
+    {
+	Queue& own = *queues_[self];
+	lock_guard<mutex> guard(own.lock);
+	if (!own.tasks.empty()) {
+	    task = move(own.tasks.back());
+	    own.tasks.pop_back();
+	    return true;
+	}
+    }
+
+    // then the oldest task of any other worker
+    int count = int(queues_.size());
+    for (int offset = 1; offset < count; offset++) {
+	Queue& victim = *queues_[(self + offset) % count];
+	lock_guard<mutex> guard(victim.lock);
+	if (!victim.tasks.empty()) {
+	    task = move(victim.tasks.front());
+	    victim.tasks.pop_front();
+	    return true;
+	}
+    }
+    return false;
+}
+
+void ThreadPool::run(int self) {
+    currentPool = this;
+    currentWorker = self;
+
+    for (;;) {
+	function<void()> task;
+	if (take(self, task)) {
+	    queued_--;
+	    task();
+	    if (--unfinished_ == 0) {
+		lock_guard<mutex> guard(idleLock_);
+		done_.notify_all();
+	    }
+	    continue;
+	}
+
+	// nothing to run or steal, sleep until something is queued
+	unique_lock<mutex> guard(idleLock_);
+	wake_.wait(guard, [this] { return queued_ > 0 || stopping_; });
+	if (stopping_ && queued_ == 0) {
+	    return;
+	}
+    }
+}
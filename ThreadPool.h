@@ -0,0 +1,106 @@
+#ifndef SPACEPIG_THREADPOOL_H
+#define SPACEPIG_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spacePig {
+
+/**
+ * A fixed set of worker threads with one task queue each.
+ * A worker runs the newest task from its own queue, and when that is
+ * empty it steals the oldest task from another worker's queue, so
+ * uneven tasks still keep every core busy. Tasks submitted from a
+ * worker go onto that worker's own queue; other submissions are dealt
+ * out round robin.
+ */
+class ThreadPool {
+public:
+    /**
+     * Start the worker threads.
+     */
+    explicit ThreadPool(/** number of workers, 0 for one per core */ int threads = 0);
+
+    /**
+     * Finish every submitted task and stop the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a task to run on one of the workers.
+     */
+    void submit(/** the task */ std::function<void()> task);
+
+    /**
+     * Block until every submitted task has finished.
+     */
+    void wait();
+
+    /**
+     * The number of worker threads.
+     * @return the worker count
+     */
+    int size() const noexcept;
+
+private:
+    /** One worker's queue of tasks */
+    struct Queue {
+	/** guards tasks */
+	std::mutex lock;
+
+	/** tasks waiting to run, newest at the back */
+	std::deque<std::function<void()>> tasks;
+    };
+
+    /** a queue per worker */
+    std::vector<std::unique_ptr<Queue>> queues_;
+
+    /** the worker threads */
+    std::vector<std::thread> threads_;
+
+    /** guards sleeping and waking */
+    std::mutex idleLock_;
+
+    /** signalled when tasks are queued or the pool stops */
+    std::condition_variable wake_;
+
+    /** signalled when the last unfinished task finishes */
+    std::condition_variable done_;
+
+    /** tasks sitting in a queue */
+    std::atomic<int> queued_;
+
+    /** tasks submitted but not yet finished */
+    std::atomic<int> unfinished_;
+
+    /** queue the next outside submission goes to */
+    std::atomic<unsigned> nextQueue_;
+
+    /** whether the workers should exit */
+    bool stopping_ = false;
+
+    /**
+     * Take a task from a worker's own queue, or steal one.
+     * @return true if a task was found
+     */
+    bool take(/** index of the worker */ int self,
+	    /** receives the task */ std::function<void()>& task);
+
+    /**
+     * The body of a worker thread.
+     */
+    void run(/** index of the worker */ int self);
+};
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SPACEPIG_TRIPLEBUFFER_H
+#define SPACEPIG_TRIPLEBUFFER_H
+
+#include <atomic>
+
+namespace spacePig {
+
+/**
+ * Hands values from one writer thread to one reader thread without
+ * locks. The writer fills the back slot and publishes it; the reader
+ * picks up the most recently published slot whenever it likes. A
+ * third slot sits between them, so neither ever waits for the other
+ * and the reader never sees a slot being written. Values published
+ * faster than they are read are dropped, all but the latest.
+ *
+ * The slots are reused rather than copied, so the writer should
+ * overwrite every part of a value it fills in.
+ */
+template <class T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * The slot the writer fills in. Only the writer may use it.
+     * @return the back slot
+     */
+    T& back() noexcept {
+	return slots_[back_];
+    }
+
+    /**
+     * Publish the back slot to the reader and take a free one back.
+     * Only the writer may publish.
+     */
+    void publish() noexcept {
+	back_ = middle_.exchange(back_ | fresh, std::memory_order_acq_rel) & slot;
+    }
+
+    /**
+     * Pick up the latest published slot, if one was published since
+     * the last call. Only the reader may update.
+     * @return true if there was a new slot
+     */
+    bool update() noexcept {
+	if (!(middle_.load(std::memory_order_relaxed) & fresh)) {
+	    return false;
+	}
+	front_ = middle_.exchange(front_, std::memory_order_acq_rel) & slot;
+	return true;
+    }
+
+    /**
+     * The slot the reader last picked up. Only the reader may use it.
+     * @return the front slot
+     */
+    const T& front() const noexcept {
+	return slots_[front_];
+    }
+
+private:
+    /** bits of middle_ holding a slot index */
+    static const unsigned slot = 3;
+
+    /** bit of middle_ set while it holds a slot not yet read */
+    static const unsigned fresh = 4;
+
+    /** the values */
+    T slots_[3];
+
+    /** index of the writer's slot */
+    unsigned back_ = 0;
+
+    /** index of the slot between the two, and whether it is fresh */
+    std::atomic<unsigned> middle_{ 1 };
+
+    /** index of the reader's slot */
+    unsigned front_ = 2;
+};
+
+}
+
+#endif
@@ -1,77 +1,136 @@
 #include "Wave.h"
-#include <chrono>
 using namespace std;
 using namespace spacePig;
 
-int Wave::nextWave_ = 1;
+Wave::Wave() {}
+
+Wave::Wave(int wave, unsigned seed, const WaveParams& params,
+    const Pattern* pattern, unique_ptr<Arena> arena) :
+    arena_(arena ? std::move(arena) : unique_ptr<Arena>(new Arena())),
+    wave_(wave),
+    seed_(seed),
+    params_(params),
+    released_(450, 800, arena_.get()),
+    grid_(450, 800, 32, arena_.get()) {
+    if (pattern) {
+	emitter_ = PatternEmitter(*pattern);
+	patternCount_ = pattern->getMaxProjectiles();
+    }
 
-Wave::Wave() {
-    // seed the engine with a time seed
-    unsigned seed = chrono::system_clock::now().time_since_epoch().count();
-    engine_.seed(seed);
-    wave_ = ++nextWave_;
+    // the wave's own draws come from the stream after the last
+    // possible projectile index
+    CounterRng rng(seed_, wave_, ~0ULL);
+    unsigned pick = 1 + unsigned(rng.nextDouble() * wave_);
 
-    std::uniform_int_distribution<unsigned int> dist(1, wave_);
-    dist_ = dist;
+    // create wave count to wave count squared projectiles for the wave
+    count_ = int(pick * wave_ * params.countFactor);
+    reserve();
+}
 
-    int val = dist_(engine_) * wave_;
+Wave::Wave(const Wave& other) :
+    wave_(other.wave_),
+    seed_(other.seed_),
+    params_(other.params_),
+    count_(other.count_),
+    patternCount_(other.patternCount_),
+    nextRelease_(other.nextRelease_),
+    emitter_(other.emitter_),
+    targetX_(other.targetX_),
+    targetY_(other.targetY_),
+    released_(other.released_),
+    grid_(other.grid_) {
+    reserve();
+}
 
-    // create wave count to wave count squared projectiles for the wave
-    for (int ii = 0; ii < val; ii++) {
-	waiting_.push_back(Projectile(engine_, wave_));
-    } 
+Wave& Wave::operator=(const Wave& other) {
+    // everything but the arena, which stays this wave's own
+    wave_ = other.wave_;
+    seed_ = other.seed_;
+    params_ = other.params_;
+    count_ = other.count_;
+    patternCount_ = other.patternCount_;
+    nextRelease_ = other.nextRelease_;
+    emitter_ = other.emitter_;
+    targetX_ = other.targetX_;
+    targetY_ = other.targetY_;
+    released_ = other.released_;
+    grid_ = other.grid_;
+    reserve();
+    return *this;
+}
 
+unique_ptr<Arena> Wave::takeArena() noexcept {
+    return std::move(arena_);
 }
 
-std::vector<Projectile> Wave::getWaiting() const noexcept {
-    return waiting_;
+ProjectileView Wave::getReleased() const noexcept {
+    return released_.view();
 }
 
-std::vector<Projectile> Wave::getReleased() const noexcept {
-    return released_;
+int Wave::getWaitingCount() const noexcept {
+    return count_ - nextRelease_;
 }
 
 int Wave::getReleasedCount() const noexcept {
     return released_.size();
 }
 
+const PatternEmitter& Wave::getEmitter() const noexcept {
+    return emitter_;
+}
+
 int Wave::getWave() const noexcept {
 	return wave_;
 }
 
 void Wave::release(int count) noexcept {
 	// ensure no out of range errors
-	if (count > waiting_.size()) {
-		count = waiting_.size();
+	if (count > getWaitingCount()) {
+		count = getWaitingCount();
+	}
+	if (count <= 0) {
+		return;
 	}
 
-        // schedule projectiles for release
-	vector<Projectile>::iterator iter = waiting_.begin();
-	for (int ii = 0; ii < count; ii++) {
-		waiting_.at(0).allowMove();
-		released_.push_back(waiting_.at(0));
-		waiting_.erase(iter);
+	// generate the next run of projectiles straight into the pool,
+	// which has room for them all. They join the collision grid when
+	// onTick() rebuilds it
+	for (int ii = 0; ii < count; ii++, nextRelease_++) {
+	    released_.push(Projectile(CounterRng(seed_, wave_, nextRelease_),
+		wave_, params_));
 	}
 }
 
-void Wave::resetWaveCount() noexcept {
-	nextWave_ = 0;
+void Wave::reserve() {
+    released_.reserve(count_ + patternCount_);
+    grid_.reserve(count_ + patternCount_);
+}
+
+void Wave::releaseAll() noexcept {
+	release(getWaitingCount());
+}
+
+bool Wave::isCleared() const noexcept {
+    return released_.empty() && getWaitingCount() == 0 && emitter_.isFinished();
+}
+
+void Wave::setTarget(float x, float y) noexcept {
+    targetX_ = x;
+    targetY_ = y;
 }
 
 void Wave::onTick(double delta) noexcept {
-    // handle any projectiles that have exited the screen area
-    for (vector<Projectile>::iterator iter = released_.begin(); iter != released_.end();) {
-	if (iter->offScreen()) {
-	    iter = released_.erase(iter);
-	}
-	else {
-	    iter++;
-	}
-    }
+    // emit whatever the pattern has due, then retire the projectiles
+    // that exited the screen area last tick and move the rest
+    emitter_.update(delta, targetX_, targetY_, released_);
+    released_.step(delta);
+    grid_.rebuild(released_);
+}
 
-    // move any remaining projectiles
-    for (int ii = 0; ii < released_.size();ii++) {
-	   released_.at(ii).move(delta);
-    }
+bool Wave::collides(const Circle* circles, int count) const noexcept {
+    return grid_.collides(released_, circles, count);
+}
 
+bool Wave::sweeps(const Circle* from, const Circle* to, int count) const noexcept {
+    return grid_.sweeps(released_, from, to, count);
 }
@@ -1,38 +1,87 @@
 #ifndef SPACEPIG_WAVE_H
 #define SPACEPIG_WAVE_H
 
-#include <set>
 #include <memory>
-#include <random>
+#include "Arena.h"
 #include "Projectile.h"
+#include "ProjectilePool.h"
+#include "CollisionGrid.h"
+#include "Pattern.h"
+#include "WaveParams.h"
 
 namespace spacePig {
 
 /**
  * A wave stores projectiles for one "round" of play.
  * The projectiles are separated into those that are waiting
- * to be released, and those that have been released.
- * When there are no projectiles left in the wave, a new round
- * is ready to be started.
+ * to be released, and those that have been released. Every
+ * projectile is drawn from its own counter-based random stream,
+ * so waiting projectiles are not stored at all: each is generated
+ * from its index when it is released.
+ * A wave may also play a bullet pattern, whose projectiles are
+ * emitted straight into the released pool alongside the random ones.
+ * When there are no projectiles left in the wave and its pattern has
+ * finished, a new round is ready to be started.
+ *
+ * A wave keeps its projectiles in an arena of its own, which can be
+ * handed on to generate a later wave in once this one is over.
  */
 
 class Wave {
 public:
-    /** Construct a wave. Because of the static wave id, we use no params */
+    /** Construct an empty wave, for before any game has started */
     Wave();
 
     /**
-     * All of the projectiles in this wave waiting to be released.
-     * @return the projectiles waiting for release
+     * Construct a wave and decide how many projectiles it has. The
+     * same wave number, seed and parameters always generate the same
+     * wave. Room for every projectile of the wave, and every one its
+     * pattern can emit, is allocated here, so that releasing them and
+     * playing the wave never allocate.
+     * @throw bad_alloc or length_error if there is not the memory
+     * for the wave.
      */
-    std::vector<Projectile> getWaiting() const noexcept;
+    Wave(/** the wave number */ int wave,
+	/** seed for the random number engine */ unsigned seed,
+	/** how to generate the wave */ const WaveParams& params = WaveParams(),
+	/** pattern to play, which must outlive the wave, or null for none */
+	const Pattern* pattern = nullptr,
+	/** arena to store the projectiles in, or null for a new one */
+	std::unique_ptr<Arena> arena = nullptr);
+
+    /**
+     * Copy a wave. The copy keeps its projectiles on the heap, or in
+     * its own arena when assigned to, never in the original's arena,
+     * with room for the rest of the wave's projectiles.
+     */
+    Wave(const Wave& other);
+    Wave& operator=(const Wave& other);
+
+    Wave(Wave&& other) = default;
+    Wave& operator=(Wave&& other) = default;
+
+    /**
+     * Give up the wave's arena so that a later wave can be generated
+     * in it. Afterwards the wave may only be destroyed or have another
+     * wave moved into it.
+     * @return the arena, or null if the wave has none
+     */
+    std::unique_ptr<Arena> takeArena() noexcept;
 
     /**
      * All of the projectiles that have been released and are not yet
-     * off screen.
+     * off screen, along with any that left the screen during the last
+     * tick, which are retired at the next. The view does not copy,
+     * and is invalidated by release() and onTick().
      * @return the projectiles that have been released
      */
-    std::vector<Projectile> getReleased() const noexcept;
+    ProjectileView getReleased() const noexcept;
+
+    /**
+     * The number of projectiles still waiting to be released.
+     * @return the number of waiting projectiles
+     */
+    int getWaitingCount() const noexcept;
 
     /** The number of released projectiles so far 
      *
@@ -47,40 +96,105 @@ public:
     int getWave() const noexcept;
 
     /**
-     * resets the static wave count
+     * The emitter playing the wave's pattern, which is finished from
+     * the start when the wave has none.
+     * @return the wave's pattern emitter
      */
-    void resetWaveCount() noexcept;
+    const PatternEmitter& getEmitter() const noexcept;
 
     /**
-     * release a number of projectiles from the waiting vector.
+     * generate and release a number of waiting projectiles, in index
+     * order. Takes time proportional to count, and never allocates.
+     * The projectiles are only tested for collisions once onTick()
+     * has moved them.
      * if the count is greater than the number of waiting projectiles,
      * release all that are left.
      */	
     void release(/** number of projectiles to release */ int count = 1) noexcept;
 
     /**
-     * move each projectile that has been released by velocity * delta
+     * release every projectile still waiting, as one burst.
+     */
+    void releaseAll() noexcept;
+
+    /**
+     * Whether or not every projectile has been released and left the
+     * screen, and the pattern, if any, has finished.
+     * @return true if the wave is over
+     */
+    bool isCleared() const noexcept;
+
+    /**
+     * Set the point the pattern aims at, normally the player's center.
+     */
+    void setTarget(/** x-coordinate */ float x, /** y-coordinate */ float y) noexcept;
+
+    /**
+     * run the pattern over delta time, then move each projectile that
+     * has been released by velocity * delta. Never allocates.
      */
     void onTick(/** time */ double delta = 0.01) noexcept;
 
+    /**
+     * Check whether any of the circles overlaps a released projectile.
+     * Only the projectiles in the grid cells near each circle are tested,
+     * and the grid only holds those released before the last onTick().
+     * @return true if there is a collision
+     */
+    bool collides(/** circles to test */ const Circle* circles,
+		/** number of circles */ int count = 1) const noexcept;
+
+    /**
+     * Check whether any of the circles touched a released projectile
+     * at any time during the last tick, with each circle moving in a
+     * straight line over the tick and each projectile following its
+     * own path, bounces included.
+     * @return true if there is a collision
+     */
+    bool sweeps(/** circles at the start of the tick */ const Circle* from,
+		/** the same circles at the end of the tick */ const Circle* to,
+		/** number of circles */ int count = 1) const noexcept;
+
 private:
-    /* static variable to store wave number */
-    static int nextWave_;
+    /* storage for released_ and grid_, declared first to outlive them */
+    std::unique_ptr<Arena> arena_;
 
     /* the wave number of this wave */	
     int wave_ = 0;
 
-    /* vector of projectiles waiting to be released */
-    std::vector<Projectile> waiting_;
+    /* seed the projectiles' streams are keyed by */
+    unsigned seed_ = 0;
 
-    /* vector of projectiles that have been released */
-    std::vector<Projectile> released_;
+    /* how to generate the projectiles */
+    WaveParams params_;
 
-    /* a uniform int distribution for random numbers */
-    std::uniform_int_distribution<unsigned int> dist_;
+    /* number of projectiles in the wave */
+    int count_ = 0;
 
-    /* mersenne twister engine for random numbers */
-    std::mt19937 engine_;
+    /* most projectiles the wave's pattern can emit */
+    int patternCount_ = 0;
+
+    /* index of the next projectile to release */
+    int nextRelease_ = 0;
+
+    /* runs the wave's pattern, if it has one */
+    PatternEmitter emitter_;
+
+    /* point the pattern aims at */
+    float targetX_ = 0.0f;
+    float targetY_ = 0.0f;
+
+    /* pool of projectiles that have been released */
+    ProjectilePool released_;
+
+    /* broad phase over released_, rebuilt whenever it changes */
+    CollisionGrid grid_;
+
+    /**
+     * Allocate room for every projectile of the wave and of its
+     * pattern, so that releasing and emitting them never reallocates.
+     */
+    void reserve();
 };
 
 }
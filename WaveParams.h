@@ -0,0 +1,31 @@
+#ifndef SPACEPIG_WAVEPARAMS_H
+#define SPACEPIG_WAVEPARAMS_H
+
+namespace spacePig {
+
+/**
+ * Tuning knobs for how a wave is generated.
+ * The defaults reproduce the original game: wave to wave squared
+ * projectiles, falling at 150 to 650 px/s, drifting sideways at up
+ * to 600 px/s plus 50 px/s for every wave.
+ */
+struct WaveParams {
+    /** scales the wave to wave squared projectile count */
+    double countFactor = 1.0;
+
+    /** slowest downward speed of a projectile */
+    double vyMin = 150.0;
+
+    /** spread of the downward speed above vyMin */
+    double vyRange = 500.0;
+
+    /** spread of the sideways speed on either side of the drift */
+    double vxRange = 600.0;
+
+    /** sideways drift added for every wave */
+    double vxPerWave = 50.0;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include "WavePrefetcher.h"
+
+using namespace std;
+using namespace spacePig;
+
+WavePrefetcher::~WavePrefetcher() {
+    {
+	lock_guard<mutex> guard(lock_);
+	stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+	thread_.join();
+    }
+}
+
+void WavePrefetcher::request(int wave, unsigned seed, const WaveParams& params,
+    const Pattern* pattern, unique_ptr<Arena> arena) noexcept {
+    take();
+
+    unique_lock<mutex> guard(lock_);
+    number_ = wave;
+    seed_ = seed;
+    params_ = params;
+    pattern_ = pattern;
+    arena_ = std::move(arena);
+    requested_ = true;
+    ready_ = false;
+
+    if (!thread_.joinable()) {
+	try {
+	    thread_ = thread(&WavePrefetcher::run, this);
+	}
+	catch (const system_error&) {
+	    // no thread to spare, so generate it here and now
+	    generate(guard);
+	    return;
+	}
+    }
+    guard.unlock();
+    wake_.notify_one();
+}
+
+Wave WavePrefetcher::take() noexcept {
+    unique_lock<mutex> guard(lock_);
+    if (!requested_) {
+	return Wave();
+    }
+    done_.wait(guard, [this] { return ready_; });
+    requested_ = false;
+    ready_ = false;
+    return std::move(wave_);
+}
+
+void WavePrefetcher::run() noexcept {
+    unique_lock<mutex> guard(lock_);
+    for (;;) {
+	wake_.wait(guard, [this] { return stopping_ || (requested_ && !ready_); });
+	if (stopping_) {
+	    return;
+	}
+	generate(guard);
+    }
+}
+
+void WavePrefetcher::generate(unique_lock<mutex>& guard) {
+    int number = number_;
+    unsigned seed = seed_;
+    WaveParams params = params_;
+    const Pattern* pattern = pattern_;
+    unique_ptr<Arena> arena = std::move(arena_);
+    guard.unlock();
+
+    // out of memory, or asked for more than a vector can hold, hand over
+    // an empty wave instead, which the session sees is not the one it
+    // asked for and generates itself
+    Wave wave;
+    try {
+	wave = Wave(number, seed, params, pattern, std::move(arena));
+    }
+    catch (const bad_alloc&) {
+	wave = Wave();
+    }
+    catch (const length_error&) {
+	wave = Wave();
+    }
+
+    guard.lock();
+    wave_ = std::move(wave);
+    ready_ = true;
+    done_.notify_all();
+}
@@ -0,0 +1,108 @@
+#ifndef SPACEPIG_WAVEPREFETCHER_H
+#define SPACEPIG_WAVEPREFETCHER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Arena.h"
+#include "Pattern.h"
+#include "Wave.h"
+#include "WaveParams.h"
+
+namespace spacePig {
+
+/**
+ * Generates waves one at a time on a worker thread of its own, so a
+ * session can prepare its next wave while the player is between
+ * waves. The thread is started by the first request and kept until
+ * the prefetcher is destroyed, so later requests neither start
+ * threads nor allocate beyond what the wave itself needs.
+ */
+class WavePrefetcher {
+public:
+    WavePrefetcher() = default;
+
+    /**
+     * Wait for any wave being generated, then stop the worker.
+     */
+    ~WavePrefetcher();
+
+    WavePrefetcher(const WavePrefetcher&) = delete;
+    WavePrefetcher& operator=(const WavePrefetcher&) = delete;
+
+    /**
+     * Start generating a wave and allocating everything it will need.
+     * A wave requested earlier and not taken is dropped. If no thread
+     * can be started, the wave is generated right away instead.
+     */
+    void request(/** the wave number */ int wave,
+	    /** seed for the random number engine */ unsigned seed,
+	    /** how to generate the wave */ const WaveParams& params,
+	    /** pattern to play, or null for none */ const Pattern* pattern,
+	    /** arena to store the wave in, or null for a new one */
+	    std::unique_ptr<Arena> arena) noexcept;
+
+    /**
+     * Wait for the requested wave and take it.
+     * @return the wave, or an empty wave if none was requested
+     */
+    Wave take() noexcept;
+
+private:
+    /** the worker thread */
+    std::thread thread_;
+
+    /** guards everything below */
+    std::mutex lock_;
+
+    /** signalled when a wave is requested or the worker should stop */
+    std::condition_variable wake_;
+
+    /** signalled when the requested wave is ready */
+    std::condition_variable done_;
+
+    /** whether a wave has been requested and not yet taken */
+    bool requested_ = false;
+
+    /** whether the requested wave has been generated */
+    bool ready_ = false;
+
+    /** whether the worker should exit */
+    bool stopping_ = false;
+
+    /** the requested wave number */
+    int number_ = 0;
+
+    /** seed for the requested wave */
+    unsigned seed_ = 0;
+
+    /** how to generate the requested wave */
+    WaveParams params_;
+
+    /** pattern for the requested wave */
+    const Pattern* pattern_ = nullptr;
+
+    /** arena to generate the requested wave in */
+    std::unique_ptr<Arena> arena_;
+
+    /** the generated wave */
+    Wave wave_;
+
+    /**
+     * The body of the worker thread.
+     */
+    void run() noexcept;
+
+    /**
+     * Generate the requested wave. Called with the lock held, which
+     * is released while the wave is generated. If there is not the
+     * memory for it, the wave handed over is an empty one, which the
+     * session generates again itself.
+     */
+    void generate(/** the held lock */ std::unique_lock<std::mutex>& guard);
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "BatchRunner.h"
+
+using namespace std;
+using namespace spacePig;
+
+/**
+ * Difficulty sweep for the game. Plays a batch of seeded headless
+ * games for each combination of projectile count and sideways drift
+ * in a small grid around the shipped tuning, spread over every core,
+ * and prints one CSV row of survival and throughput statistics per
+ * combination.
+ *
+ * usage: SpacePigBatch [games per point] [threads] [base seed] [max ticks] [tick rate]
+ *
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    int games = argc > 1 ? atoi(argv[1]) : 1000;
+    int threads = argc > 2 ? atoi(argv[2]) : 0;
+    unsigned seed = argc > 3 ? unsigned(strtoul(argv[3], nullptr, 10)) : 1;
+    unsigned long long maxTicks = argc > 4 ? strtoull(argv[4], nullptr, 10) : 36000;
+    double tickRate = argc > 5 ? atof(argv[5]) : 60.0;
+
+    const double countFactors[] = { 0.5, 1.0, 2.0 };
+    const double drifts[] = { 25.0, 50.0, 100.0 };
+
+    BatchRunner runner(threads, maxTicks, tickRate);
+    cerr << "running " << games << " games per point on "
+	 << runner.getThreadCount() << " threads" << endl;
+
+    cout << "count_factor,vx_per_wave,games,mean_wave,median_wave,max_wave,"
+	 << "survival_rate,ticks,seconds,ticks_per_second,ticks_per_second_per_thread" << endl;
+    for (double countFactor : countFactors) {
+	for (double drift : drifts) {
+	    WaveParams params;
+	    params.countFactor = countFactor;
+	    params.vxPerWave = drift;
+
+	    BatchSummary summary = runner.summarize(params, games, seed);
+	    cout << countFactor << ',' << drift << ',' << summary.games << ','
+		 << summary.meanWave << ',' << summary.medianWave << ','
+		 << summary.maxWave << ',' << summary.survivalRate << ','
+		 << summary.ticks << ',' << summary.seconds << ','
+		 << summary.ticksPerSecond << ','
+		 << summary.ticksPerSecond / runner.getThreadCount() << endl;
+	}
+    }
+    return 0;
+}
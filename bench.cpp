@@ -0,0 +1,265 @@
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Display.h"
+#include "GameSession.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** Result of one benchmark at one size. */
+struct BenchResult {
+    /** name of the benchmarked path */
+    string name;
+
+    /** wave number or projectile count the path was run at */
+    int param;
+
+    /** projectiles live while the path ran */
+    int live;
+
+    /** number of timed samples */
+    int samples;
+
+    /** median nanoseconds per operation */
+    double median;
+
+    /** fastest nanoseconds per operation */
+    double min;
+};
+
+/** Keeps the optimizer from discarding benchmarked results. */
+volatile long long sink = 0;
+
+/** Timed seconds spent on each benchmark at each size. */
+double budget = 0.25;
+
+/**
+ * Time an operation until the budget runs out, restoring its
+ * state before every sample outside of the timed region.
+ * @return the timings, per operation
+ */
+BenchResult measure(/** name of the benchmarked path */ const string& name,
+	/** wave number or projectile count */ int param,
+	/** projectiles live while the path runs */ int live,
+	/** operations performed by one call of body */ int ops,
+	/** untimed preparation for a sample */ const function<void()>& setup,
+	/** the timed sample */ const function<void()>& body) {
+    vector<double> times;
+    double total = 0.0;
+    while ((total < budget || times.size() < 5) && times.size() < 100000) {
+	setup();
+	auto start = chrono::steady_clock::now();
+	body();
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	total += elapsed;
+	times.push_back(elapsed * 1e9 / ops);
+    }
+    sort(times.begin(), times.end());
+
+    BenchResult result;
+    result.name = name;
+    result.param = param;
+    result.live = live;
+    result.samples = int(times.size());
+    result.median = times[times.size() / 2];
+    result.min = times.front();
+    return result;
+}
+
+/**
+ * A wave whose projectiles have all been released and have had
+ * time to spread down the screen. Wave 1 always holds exactly
+ * countFactor projectiles, so the count can be set directly.
+ * @return the wave
+ */
+Wave spreadWave(/** number of projectiles */ int count) {
+    WaveParams params;
+    params.countFactor = count;
+    Wave wave(1, 1, params);
+    wave.releaseAll();
+    for (int tick = 0; tick < 40; tick++) {
+	wave.onTick();
+    }
+    return wave;
+}
+
+void benchWave(vector<BenchResult>& results) {
+    static const int waves[] = { 1, 10, 25, 50, 100, 150 };
+    for (int number : waves) {
+	int live = Wave(number, 1, WaveParams()).getWaitingCount();
+	results.push_back(measure("Wave::Wave", number, live, 1,
+	    [] {},
+	    [number] {
+		Wave wave(number, 1, WaveParams());
+		sink += wave.getWaitingCount();
+	    }));
+    }
+
+    static const int counts[] = { 100, 1000, 10000, 50000 };
+    for (int count : counts) {
+	// release a burst one at a time, as the session does, on top
+	// of a wave that already has count projectiles live
+	const int burst = 16;
+	WaveParams params;
+	params.countFactor = count + burst;
+	Wave full(1, 1, params);
+	full.release(count);
+	Wave wave;
+	results.push_back(measure("Wave::release", count, count, burst,
+	    [&] { wave = full; },
+	    [&] {
+		for (int ii = 0; ii < burst; ii++) {
+		    wave.release();
+		}
+		sink += wave.getReleasedCount();
+	    }));
+    }
+
+    for (int count : counts) {
+	Wave spread = spreadWave(count);
+	Wave wave;
+	// a short burst, so the live count barely changes within a sample
+	const int ticks = 16;
+	results.push_back(measure("Wave::onTick", count, spread.getReleasedCount(), ticks,
+	    [&] { wave = spread; },
+	    [&] {
+		for (int ii = 0; ii < ticks; ii++) {
+		    wave.onTick();
+		}
+		sink += wave.getReleasedCount();
+	    }));
+    }
+}
+
+void benchPlayer(vector<BenchResult>& results) {
+    // spread the player over the screen so that the walk visits
+    // both crowded and empty parts of the grid
+    vector<Player> players;
+    for (int y = 100; y < 800; y += 175) {
+	for (int x = 50; x < 450; x += 100) {
+	    Player player(450, 800);
+	    player.move(x, y);
+	    players.push_back(player);
+	}
+    }
+
+    static const int counts[] = { 100, 1000, 10000, 50000 };
+    for (int count : counts) {
+	Wave wave = spreadWave(count);
+	results.push_back(measure("Player::hasDied", count, wave.getReleasedCount(),
+	    int(players.size()),
+	    [] {},
+	    [&] {
+		for (const Player& player : players) {
+		    sink += player.hasDied(wave);
+		}
+	    }));
+    }
+}
+
+void benchDisplay(vector<BenchResult>& results) {
+    // draw off screen with the software renderer and no vsync, unless
+    // the caller picked a video driver of their own
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+
+    try {
+	GameDisplay display(Player(450, 800), 450, 800);
+
+	static const int counts[] = { 0, 100, 1000, 10000 };
+	for (int count : counts) {
+	    Wave wave = spreadWave(count);
+	    display.getSession().setWave(wave);
+	    results.push_back(measure("GameDisplay::refresh", count, wave.getReleasedCount(), 1,
+		[] {},
+		[&] { display.refresh(); }));
+	}
+    }
+    catch (const exception& e) {
+	cerr << "Skipping GameDisplay::refresh: " << e.what() << endl;
+    }
+}
+
+void writeCsv(const vector<BenchResult>& results) {
+    cout << "benchmark,param,live,samples,median_ns,min_ns" << endl;
+    for (const BenchResult& result : results) {
+	cout << result.name << ',' << result.param << ',' << result.live << ','
+	     << result.samples << ',' << result.median << ',' << result.min << endl;
+    }
+}
+
+void writeJson(const vector<BenchResult>& results) {
+    cout << "[" << endl;
+    for (size_t ii = 0; ii < results.size(); ii++) {
+	const BenchResult& result = results[ii];
+	cout << "  {\"benchmark\": \"" << result.name << "\", \"param\": " << result.param
+	     << ", \"live\": " << result.live << ", \"samples\": " << result.samples
+	     << ", \"median_ns\": " << result.median << ", \"min_ns\": " << result.min
+	     << "}" << (ii + 1 < results.size() ? "," : "") << endl;
+    }
+    cout << "]" << endl;
+}
+
+}
+
+/**
+ * Microbenchmarks for the game's hot paths: building, releasing and
+ * stepping waves, the player's hit test, and drawing a frame. Each
+ * path is run at a range of wave numbers or projectile counts and
+ * reported as nanoseconds per operation, one row per path and size,
+ * so runs can be compared as bullet counts grow.
+ *
+ * usage: SpacePigBench [--json] [--no-display] [--budget seconds]
+ *
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    bool json = false;
+    bool display = true;
+    for (int ii = 1; ii < argc; ii++) {
+	if (strcmp(argv[ii], "--json") == 0) {
+	    json = true;
+	}
+	else if (strcmp(argv[ii], "--no-display") == 0) {
+	    display = false;
+	}
+	else if (strcmp(argv[ii], "--budget") == 0 && ii + 1 < argc) {
+	    budget = atof(argv[++ii]);
+	}
+	else {
+	    cerr << "usage: " << argv[0] << " [--json] [--no-display] [--budget seconds]" << endl;
+	    return 1;
+	}
+    }
+
+    vector<BenchResult> results;
+    cout << fixed << setprecision(1);
+    benchWave(results);
+    benchPlayer(results);
+    if (display) {
+	benchDisplay(results);
+    }
+
+    if (json) {
+	writeJson(results);
+    }
+    else {
+	writeCsv(results);
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include "GameSession.h"
+#include "InputRecorder.h"
+
+using namespace std;
+using namespace spacePig;
+
+/**
+ * Headless driver for the game. Runs a GameSession for a number of
+ * simulation steps as fast as possible, with no window, renderer or
+ * vsync, and reports how far the games got and how fast they ran.
+ * A seeded random walk stands in for the player's keyboard, and the
+ * session is restarted whenever the player dies.
+ *
+ * Given --replay and a file recorded with SpacePig --record, instead
+ * re-runs that game and checks it against the recorded checkpoints.
+ * A game played with --patterns needs the same pattern file here.
+ *
+ * The tick rate sets how many simulation steps make up a second of
+ * game time; lower rates take longer steps and run faster.
+ *
+ * usage: SpacePigHeadless [ticks] [input seed] [tick rate]
+ *        SpacePigHeadless --replay recording [pattern file]
+ *
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+	try {
+	    ReplayResult result = replayInputs(argv[2],
+		argc > 3 ? Pattern::load(argv[3]) : vector<Pattern>());
+	    cout << "ticks: " << result.ticks << endl
+		 << "commands: " << result.commands << endl
+		 << "checkpoints: " << result.checkpoints << endl
+		 << "mismatches: " << result.mismatches << endl;
+	    if (result.mismatches > 0) {
+		cout << "first mismatch at tick: " << result.firstMismatch << endl;
+	    }
+	    cout << "seconds: " << result.seconds << endl
+		 << "ticks per second: " << (result.seconds > 0 ? result.ticks / result.seconds : 0) << endl;
+	    return result.mismatches > 0 ? 1 : 0;
+	}
+	catch (const exception& e) {
+	    cerr << e.what() << endl;
+	    return 1;
+	}
+    }
+
+    unsigned long long ticks = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned seed = argc > 2 ? unsigned(strtoul(argv[2], nullptr, 10)) : 1;
+    double tickRate = argc > 3 ? atof(argv[3]) : 60.0;
+
+    static const unsigned directions[] = { Player::Left, Player::Right, Player::Up, Player::Down };
+    mt19937 engine(seed);
+    uniform_int_distribution<int> pickDirection(0, 3);
+
+    GameSession session(Player(), tickRate);
+    session.restart();
+
+    unsigned long long deaths = 0;
+    int bestWave = 0;
+    auto start = chrono::steady_clock::now();
+    for (unsigned long long tick = 0; tick < ticks; tick++) {
+	if (session.getState() == GameSession::State::Dead) {
+	    deaths++;
+	    session.restart();
+	}
+	session.steerPlayer(directions[pickDirection(engine)]);
+	session.step();
+	if (session.getWave().getWave() > bestWave) {
+	    bestWave = session.getWave().getWave();
+	}
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "ticks: " << ticks << endl
+	 << "deaths: " << deaths << endl
+	 << "best wave: " << bestWave << endl
+	 << "seconds: " << seconds << endl
+	 << "ticks per second: " << (seconds > 0 ? ticks / seconds : 0) << endl;
+    return 0;
+}
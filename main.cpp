@@ -1,6 +1,7 @@
 #include <ctime>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 #include "Display.h"
 
@@ -21,18 +22,44 @@ using namespace spacePig;
 /**
  * Main program to get the game running.
  * Ensures that the program exits if the user has closed
- * the window.
+ * the window. Passing --profile-csv followed by a path writes
+ * per-frame phase timings to that file, --patterns followed by a
+ * path plays the bullet patterns in that file, and --record followed
+ * by a path records the game for SpacePigHeadless --replay.
  *
  * @return The status code. Status code 0 means
  * the program succeeds, and nonzero status code
  * means the program failed.
  */
-int main() {
+int main(int argc, char* argv[]) {
     try {
 	Player player(450, 800);
 
 	// Initialize the game display.
 	GameDisplay* display = new GameDisplay(player, 450, 800);
+
+	for (int ii = 1; ii < argc; ii++) {
+	    if (string(argv[ii]) == "--profile-csv" && ii + 1 < argc) {
+		string path = argv[++ii];
+		if (!display->getProfiler().openCsv(path)) {
+		    cerr << "Unable to open profile output " << path << endl;
+		}
+	    }
+	    else if (string(argv[ii]) == "--patterns" && ii + 1 < argc) {
+		try {
+		    display->getSession().setPatterns(Pattern::load(argv[++ii]));
+		}
+		catch (const domain_error& e) {
+		    cerr << e.what() << endl;
+		}
+	    }
+	    else if (string(argv[ii]) == "--record" && ii + 1 < argc) {
+		string path = argv[++ii];
+		if (!display->record(path)) {
+		    cerr << "Unable to open recording " << path << endl;
+		}
+	    }
+	}
 	
 	// loop forever so the display remains open.
 	// If the display is closed, we can exit the program.
@@ -0,0 +1,76 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+using namespace std;
+using namespace spacePig;
+
+/**
+ * Packs images for the game ahead of time. Each image is decoded and
+ * converted to ARGB8888 once, here, and all of them are written into
+ * one AssetPack, which the game maps into memory at startup in place
+ * of decoding anything.
+ *
+ * Images are keyed by the path given for them, which has to match the
+ * location the game loads them from, so run it from the game's
+ * directory. make assets packs the game's own images.
+ *
+ * usage: SpacePigPack pack image...
+ *
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+	cerr << "usage: " << argv[0] << " pack image..." << endl;
+	return 1;
+    }
+
+    map<string, AssetPack::Image> images;
+    vector<SDL_Surface*> surfaces;
+    int status = 0;
+    for (int ii = 2; ii < argc; ii++) {
+	SDL_Surface* decoded = IMG_Load(argv[ii]);
+	SDL_Surface* converted = decoded ?
+	    SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+	if (decoded) {
+	    SDL_FreeSurface(decoded);
+	}
+	if (!converted) {
+	    cerr << "Unable to load the image file at " << argv[ii]
+		 << " due to: " << SDL_GetError() << endl;
+	    status = 1;
+	    break;
+	}
+	surfaces.push_back(converted);
+
+	AssetPack::Image image;
+	image.width = converted->w;
+	image.height = converted->h;
+	image.pitch = converted->pitch;
+	image.pixels = converted->pixels;
+	images[argv[ii]] = image;
+    }
+
+    if (status == 0) {
+	if (AssetPack::write(argv[1], images)) {
+	    cout << "packed " << images.size() << " images into " << argv[1] << endl;
+	}
+	else {
+	    cerr << "Unable to write the pack " << argv[1] << endl;
+	    status = 1;
+	}
+    }
+
+    for (SDL_Surface* surface : surfaces) {
+	SDL_FreeSurface(surface);
+    }
+    IMG_Quit();
+    return status;
+}
@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Pattern.h"
+#include "Player.h"
+#include "ProjectilePool.h"
+#include "Tests.h"
+#include "Wave.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** where the test writes the pattern that fires its projectile */
+const char* patternPath = "SpacePigTests-collision.pat";
+
+/** the length of the tick, in simulated seconds */
+const double tick = 0.01;
+
+/**
+ * Fire one standard projectile and move it over one tick.
+ * @return the pattern that fired it, which the wave plays and so
+ * has to outlive it
+ */
+vector<Pattern> fire(/** center the projectile starts at */ float x, float y,
+	/** heading in degrees, 0 straight down and 90 right */ float angle,
+	/** speed in pixels per simulated second */ float speed,
+	/** the wave to fire it in */ Wave& wave) {
+    FILE* file = fopen(patternPath, "w");
+    fprintf(file, "pattern shot\norigin %g %g\nspeed %g\nangle %g\nring 1\n",
+	x, y, speed, angle);
+    fclose(file);
+    vector<Pattern> patterns = Pattern::load(patternPath);
+    remove(patternPath);
+
+    wave = Wave(1, 12345, WaveParams(), &patterns[0]);
+    wave.onTick(tick);
+    return patterns;
+}
+
+}
+
+int testCollision() {
+    int failures = 0;
+
+    // A projectile that crosses the player from one side to the other
+    // within the tick is caught, though it is clear of the player at
+    // both ends of it
+
+    {
+	Player player;
+	player.move(225, 400);
+	Wave wave;
+	vector<Pattern> shot = fire(25.0f, 400.0f, 90.0f, 40000.0f, wave);
+	Circle body = player.getBody();
+	CHECK(wave.getReleased().size() == 1);
+	CHECK(!wave.collides(&body));
+	CHECK(player.hasDied(wave));
+	CHECK(player.hasDied(wave, body));
+    }
+
+    // The same shot passing just clear of the player does not hit it
+
+    {
+	Player player;
+	player.move(225, 416);
+	Wave wave;
+	vector<Pattern> shot = fire(25.0f, 400.0f, 90.0f, 40000.0f, wave);
+	CHECK(wave.getReleased().size() == 1);
+	CHECK(!player.hasDied(wave));
+    }
+
+    // A projectile that bounces off the right wall partway through the
+    // tick hits the player standing by the wall, though the straight
+    // line from where it started to where it ended passes well clear
+
+    {
+	Player player;
+	player.move(435, 400);
+	Wave wave;
+	vector<Pattern> shot = fire(345.0f, 300.0f, 45.0f, 28284.0f, wave);
+	const ProjectilePool& pool = wave.getReleased().pool();
+	Circle body = player.getBody();
+	CHECK(wave.getReleased().size() == 1);
+	CHECK(pool.getBounceTime(0) > 0.0f && pool.getBounceTime(0) < 1.0f);
+	CHECK(pool.posx()[0] < 350.0f && pool.posy()[0] > 495.0f);
+	CHECK(!wave.collides(&body));
+	CHECK(player.hasDied(wave));
+    }
+
+    // A player moving through the path of a slow projectile over the
+    // tick is caught too
+
+    {
+	Player player;
+	player.move(225, 400);
+	Circle from = player.getBody();
+	player.move(225, 200);
+	Wave wave;
+	vector<Pattern> shot = fire(225.0f, 300.0f, 0.0f, 10.0f, wave);
+	Circle body = player.getBody();
+	CHECK(!wave.collides(&body));
+	CHECK(!wave.collides(&from));
+	CHECK(player.hasDied(wave, from));
+    }
+
+    return failures;
+}
@@ -0,0 +1,294 @@
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Pattern.h"
+#include "ProjectilePool.h"
+#include "Tests.h"
+#include "Wave.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** the example patterns shipped with the game */
+const char* examplePath = "patterns/example.pat";
+
+/** where the test writes the pattern files it compiles */
+const char* patternPath = "SpacePigTests-pattern.pat";
+
+/** degrees to radians */
+const double radians = 3.14159265358979323846 / 180.0;
+
+/**
+ * Compile a pattern file holding some text.
+ * @return the message the compiler refused it with, or an empty
+ * string if it compiled
+ */
+string compileError(/** contents of the file */ const string& text) {
+    FILE* file = fopen(patternPath, "w");
+    fputs(text.c_str(), file);
+    fclose(file);
+    try {
+	Pattern::load(patternPath);
+    }
+    catch (const domain_error& error) {
+	return error.what();
+    }
+    return string();
+}
+
+/**
+ * Whether a compiler message names the line it was about and says
+ * what was wrong with it.
+ * @return true if the message has both
+ */
+bool reports(/** the message */ const string& message, /** line of the error */ int line,
+	/** what the message should say */ const string& reason) {
+    string where = string(patternPath) + ":" + to_string(line) + ": ";
+    return message.compare(0, where.size(), where) == 0
+	&& message.find(reason) != string::npos;
+}
+
+/**
+ * Run a pattern to its end, emitting into a pool.
+ * @return the number of projectiles emitted
+ */
+int emitAll(/** pattern to run */ const Pattern& pattern) {
+    ProjectilePool pool;
+    PatternEmitter emitter(pattern);
+    for (int ticks = 0; ticks < 100000 && !emitter.isFinished(); ticks++) {
+	emitter.update(0.01, 225.0f, 700.0f, pool);
+    }
+    return emitter.isFinished() ? pool.size() : -1;
+}
+
+/** Whether two numbers are within a thousandth of each other */
+bool near(double a, double b) {
+    return fabs(a - b) < 1e-3;
+}
+
+}
+
+int testPattern() {
+    int failures = 0;
+
+    // The example file compiles to the programs it spells out
+
+    vector<Pattern> patterns = Pattern::load(examplePath);
+    CHECK(patterns.size() == 4);
+    if (patterns.size() != 4) {
+	return failures;
+    }
+    CHECK(patterns[0].getName() == "rings");
+    CHECK(patterns[1].getName() == "spiral");
+    CHECK(patterns[2].getName() == "aimed_fans");
+    CHECK(patterns[3].getName() == "bursts");
+    CHECK(patterns[0].getProgram().size() == 7);
+    CHECK(patterns[1].getProgram().size() == 7);
+    CHECK(patterns[2].getProgram().size() == 8);
+    CHECK(patterns[3].getProgram().size() == 12);
+
+    const vector<Pattern::Instruction>& rings = patterns[0].getProgram();
+    CHECK(rings[0].op == Pattern::Origin && rings[0].a == 225.0f && rings[0].b == 40.0f);
+    CHECK(rings[1].op == Pattern::Speed && rings[1].a == 180.0f);
+    CHECK(rings[2].op == Pattern::Repeat && rings[2].count == 6);
+    CHECK(rings[3].op == Pattern::Ring && rings[3].count == 16);
+    CHECK(rings[4].op == Pattern::Turn && rings[4].a == 11.25f);
+    CHECK(rings[5].op == Pattern::Wait && rings[5].a == 0.6f);
+    // the end points back at its repeat
+    CHECK(rings[6].op == Pattern::End && rings[6].count == 2);
+
+    // Each pattern emits every projectile it should, mirrored ones
+    // twice, and knows the most it can emit
+
+    CHECK(patterns[0].getMaxProjectiles() == 6 * 16);
+    CHECK(patterns[1].getMaxProjectiles() == 120 * 3);
+    CHECK(patterns[2].getMaxProjectiles() == 8 * 5 * 2);
+    CHECK(patterns[3].getMaxProjectiles() == 4 * (7 + 12) * 2);
+
+    CHECK(emitAll(patterns[0]) == 6 * 16);
+    CHECK(emitAll(patterns[1]) == 120 * 3);
+    CHECK(emitAll(patterns[2]) == 8 * 5 * 2);
+    CHECK(emitAll(patterns[3]) == 4 * (7 + 12) * 2);
+
+    // A wave playing "rings" emits its first ring from the origin,
+    // evenly around it at the pattern's speed. The pattern takes no
+    // randomness, but the wave is seeded all the same.
+
+    {
+	Wave wave(1, 12345, WaveParams(), &patterns[0]);
+	wave.onTick(0.01);
+	const ProjectilePool& pool = wave.getReleased().pool();
+	CHECK(pool.size() == 16);
+	bool placed = pool.size() == 16;
+	for (int ii = 0; ii < pool.size() && ii < 16; ii++) {
+	    double angle = 22.5 * ii * radians;
+	    placed = placed && pool.prevx()[ii] == 225.0f && pool.prevy()[ii] == 40.0f
+		&& near(pool.vx()[ii], 180.0 * sin(angle))
+		&& near(pool.vy()[ii], 180.0 * cos(angle))
+		&& pool.type()[ii] == 0;
+	}
+	CHECK(placed);
+    }
+
+    // The second ring comes 0.6 seconds after the first, turned by
+    // 11.25 degrees
+
+    {
+	ProjectilePool pool;
+	PatternEmitter emitter(patterns[0]);
+	emitter.update(0.01, 225.0f, 700.0f, pool);
+	emitter.update(0.5, 225.0f, 700.0f, pool);
+	CHECK(pool.size() == 16);
+	emitter.update(0.1, 225.0f, 700.0f, pool);
+	CHECK(pool.size() == 32);
+	bool turned = pool.size() == 32;
+	for (int ii = 16; ii < pool.size() && ii < 32; ii++) {
+	    double angle = (11.25 + 22.5 * (ii - 16)) * radians;
+	    turned = turned && pool.posx()[ii] == 225.0f && pool.posy()[ii] == 40.0f
+		&& near(pool.vx()[ii], 180.0 * sin(angle))
+		&& near(pool.vy()[ii], 180.0 * cos(angle));
+	}
+	CHECK(turned);
+    }
+
+    // Waiting out part of the gap between rings emits nothing, but
+    // still changes the emitter's state hash; two emitters at the
+    // same point of the same pattern hash alike
+
+    {
+	ProjectilePool pool;
+	PatternEmitter emitter(patterns[0]);
+	PatternEmitter twin(patterns[0]);
+	emitter.update(0.01, 225.0f, 700.0f, pool);
+	twin.update(0.01, 225.0f, 700.0f, pool);
+	CHECK(emitter.getStateHash() == twin.getStateHash());
+	unsigned long long before = emitter.getStateHash();
+	emitter.update(0.1, 225.0f, 700.0f, pool);
+	CHECK(pool.size() == 32);
+	CHECK(emitter.getStateHash() != before);
+	CHECK(emitter.getStateHash() != twin.getStateHash());
+    }
+
+    // "aimed_fans" aims its fan at the target and mirrors every
+    // projectile left to right
+
+    {
+	ProjectilePool pool;
+	PatternEmitter emitter(patterns[2]);
+	emitter.update(0.01, 60.0f, 520.0f, pool);
+	CHECK(pool.size() == 10);
+	bool fanned = pool.size() == 10;
+	for (int ii = 0; ii < 5 && ii * 2 + 1 < pool.size(); ii++) {
+	    double angle = (-20.0 + 10.0 * ii) * radians;
+	    int mirrored = ii * 2 + 1;
+	    fanned = fanned && pool.posx()[ii * 2] == 60.0f && pool.posy()[ii * 2] == 20.0f
+		&& near(pool.vx()[ii * 2], 260.0 * sin(angle))
+		&& near(pool.vy()[ii * 2], 260.0 * cos(angle))
+		&& pool.posx()[mirrored] == 390.0f && pool.posy()[mirrored] == 20.0f
+		&& pool.vx()[mirrored] == -pool.vx()[ii * 2]
+		&& pool.vy()[mirrored] == pool.vy()[ii * 2];
+	}
+	CHECK(fanned);
+    }
+
+    // A long update runs only so many instructions, leaving the rest
+    // for the updates after it
+
+    {
+	compileError("pattern a\nrepeat 10000\nring 1\nwait 0.0001\nend\n");
+	vector<Pattern> burst = Pattern::load(patternPath);
+	ProjectilePool pool;
+	PatternEmitter emitter(burst[0]);
+	emitter.update(10.0, 225.0f, 700.0f, pool);
+	CHECK(!emitter.isFinished());
+	CHECK(pool.size() > 0 && pool.size() <= PatternEmitter::maxRun);
+	for (int updates = 0; updates < 100 && !emitter.isFinished(); updates++) {
+	    emitter.update(0.0, 225.0f, 700.0f, pool);
+	}
+	CHECK(emitter.isFinished());
+	CHECK(pool.size() == 10000);
+    }
+
+    // Malformed files are refused, naming the line and the problem
+
+    CHECK(reports(compileError("pattern a\nbogus 1\n"), 2, "unknown instruction \"bogus\""));
+    CHECK(reports(compileError("ring 3\n"), 1, "before the first pattern"));
+    CHECK(reports(compileError("pattern\n"), 1, "pattern needs a name"));
+
+    // unbalanced repeat and end
+    CHECK(reports(compileError("pattern a\nrepeat 2\nring 3\n"), 3, "missing \"end\" in pattern a"));
+    CHECK(reports(compileError("pattern a\nrepeat 2\nring 3\npattern b\n"), 4,
+	"missing \"end\" in pattern a"));
+    CHECK(reports(compileError("pattern a\nring 3\nend\n"), 3, "\"end\" without \"repeat\""));
+    CHECK(reports(compileError("pattern a\nrepeat 2\nwait 1\nend\nend\n"), 5,
+	"\"end\" without \"repeat\""));
+
+    // repeats nest up to maxDepth deep and no deeper
+    string nested = "pattern a\n";
+    for (int ii = 0; ii < Pattern::maxDepth; ii++) {
+	nested += "repeat 2\n";
+    }
+    string closed = "ring 1\nwait 0.1\n";
+    for (int ii = 0; ii < Pattern::maxDepth; ii++) {
+	closed += "end\n";
+    }
+    CHECK(compileError(nested + closed).empty());
+    CHECK(reports(compileError(nested + "repeat 2\n" + closed + "end\n"), Pattern::maxDepth + 2,
+	"repeats nested too deep"));
+
+    // bad operands
+    CHECK(reports(compileError("pattern a\nfan 3\n"), 2, "bad operand for \"fan\""));
+    CHECK(reports(compileError("pattern a\nspeed fast\n"), 2, "bad operand for \"speed\""));
+    CHECK(reports(compileError("pattern a\nring -1\n"), 2, "bad operand for \"ring\""));
+    CHECK(reports(compileError("pattern a\nring 65536\n"), 2, "bad operand for \"ring\""));
+    CHECK(reports(compileError("pattern a\nmirror maybe\n"), 2, "bad operand for \"mirror\""));
+    CHECK(reports(compileError("pattern a\norigin 10\n"), 2, "bad operand for \"origin\""));
+    CHECK(reports(compileError("pattern a\nring 3 4\n"), 2, "unexpected \"4\""));
+    CHECK(reports(compileError("pattern a\naim left\n"), 2, "unexpected \"left\""));
+    CHECK(reports(compileError("pattern a\ntype 200\n"), 2, "no projectile type 200"));
+    CHECK(reports(compileError("pattern a\nwait -1\n"), 2, "wait cannot be negative"));
+    CHECK(reports(compileError("pattern a\nrepeat 0\nend\n"), 2, "repeat needs a count of at least 1"));
+
+    // every repeat has to wait, or it would run all its passes in one tick
+    CHECK(reports(compileError("pattern a\nrepeat 2\nrepeat 2\nring 10\nend\nend\n"), 5,
+	"repeat never waits"));
+    CHECK(reports(compileError("pattern a\nrepeat 3\nring 1\nwait 0\nend\n"), 5, "repeat never waits"));
+    CHECK(reports(compileError("pattern a\nrepeat 3\nrepeat 2\nring 1\nend\nwait 1\nend\n"), 5,
+	"repeat never waits"));
+    // a wait in an inner repeat is a wait for the outer one too
+    CHECK(compileError("pattern a\nrepeat 3\nrepeat 2\nring 1\nwait 0.1\nend\nend\n").empty());
+
+    // a pattern can emit only so many projectiles, mirror images included
+    CHECK(compileError("pattern a\nrepeat 100\nring 1000\nwait 0.1\nend\n").empty());
+    CHECK(reports(compileError("pattern a\nrepeat 65535\nrepeat 65535\nring 1000\nend\nend\n"), 4,
+	"more than 100000 projectiles"));
+    CHECK(reports(compileError("pattern a\nrepeat 100\nring 1001\nwait 0.1\nend\n"), 3,
+	"more than 100000 projectiles"));
+    CHECK(reports(compileError("pattern a\nrepeat 10\nrepeat 10\nfan 1001 30\nwait 0.1\nend\nend\n"), 4,
+	"more than 100000 projectiles"));
+    CHECK(reports(compileError("pattern a\nrepeat 60\nring 1000\nwait 0.1\nend\nmirror on\n"), 6,
+	"more than 100000 projectiles"));
+
+    // comments and blank lines are skipped, and count towards line numbers
+    CHECK(reports(compileError("# a comment\n\npattern a # named a\nring 3\nbogus\n"), 5,
+	"unknown instruction \"bogus\""));
+
+    remove(patternPath);
+
+    // A missing file is refused too
+    bool refused = false;
+    try {
+	Pattern::load(patternPath);
+    }
+    catch (const domain_error&) {
+	refused = true;
+    }
+    CHECK(refused);
+
+    return failures;
+}
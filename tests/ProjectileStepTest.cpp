@@ -0,0 +1,148 @@
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "ProjectileStep.h"
+#include "Tests.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** number of projectile types the batches mix */
+const int typeCount = 6;
+
+/** One batch of projectiles, in the layout the kernels take */
+struct Batch {
+    vector<float> posx;
+    vector<float> posy;
+    vector<float> vx;
+    vector<float> vy;
+    vector<unsigned char> type;
+    vector<unsigned char> offScreen;
+};
+
+/**
+ * Make a batch whose projectiles sit near the walls and exits with
+ * fast velocities, so plenty of them bounce or leave in one step.
+ * Some stand still exactly on a wall or an exit, where the kernels'
+ * comparisons have to agree on ties.
+ */
+Batch makeBatch(mt19937& random, int count, const StepWalls& walls) {
+    uniform_real_distribution<float> across(-40.0f, 490.0f);
+    uniform_real_distribution<float> down(-60.0f, 860.0f);
+    uniform_real_distribution<float> speed(-900.0f, 900.0f);
+    uniform_int_distribution<int> kind(0, typeCount - 1);
+    uniform_int_distribution<int> edge(0, 15);
+    Batch batch;
+    for (int ii = 0; ii < count; ii++) {
+	unsigned char type = (unsigned char)kind(random);
+	float x = across(random);
+	float y = down(random);
+	float u = speed(random);
+	float v = speed(random);
+	switch (edge(random)) {
+	    case 0: x = walls.left[type]; u = 0.0f; break;
+	    case 1: x = walls.right[type]; u = 0.0f; break;
+	    case 2: y = walls.bottom[type]; v = 0.0f; break;
+	    case 3: x = walls.exitLeft; u = 0.0f; break;
+	    case 4: x = walls.exitRight; u = 0.0f; break;
+	    case 5: y = walls.exitTop; v = -0.0f; break;
+	    case 6: y = walls.exitTop - 1.0f; v = 0.0f; break;
+	    default: break;
+	}
+	batch.posx.push_back(x);
+	batch.posy.push_back(y);
+	batch.vx.push_back(u);
+	batch.vy.push_back(v);
+	batch.type.push_back(type);
+    }
+    batch.offScreen.assign(count, 2);
+    return batch;
+}
+
+/**
+ * Step a copy of a batch with the scalar kernel and another with a
+ * forced kernel, starting offset projectiles in so the vector loads
+ * are unaligned too.
+ * @return the number of failed checks
+ */
+int compare(const char* name, const Batch& batch, int offset, float delta,
+    const StepWalls& walls, int& bounces, int& exits) {
+    int failures = 0;
+    int count = int(batch.posx.size()) - offset;
+    Batch expected = batch;
+    Batch actual = batch;
+    stepProjectilesScalar(&expected.posx[offset], &expected.posy[offset], &expected.vx[offset],
+	&expected.vy[offset], &expected.type[offset], count, delta, walls,
+	&expected.offScreen[offset]);
+    stepProjectiles(&actual.posx[offset], &actual.posy[offset], &actual.vx[offset],
+	&actual.vy[offset], &actual.type[offset], count, delta, walls,
+	&actual.offScreen[offset]);
+
+    size_t bytes = batch.posx.size() * sizeof(float);
+    bool same = memcmp(expected.posx.data(), actual.posx.data(), bytes) == 0
+	&& memcmp(expected.posy.data(), actual.posy.data(), bytes) == 0
+	&& memcmp(expected.vx.data(), actual.vx.data(), bytes) == 0
+	&& memcmp(expected.offScreen.data(), actual.offScreen.data(), batch.offScreen.size()) == 0;
+    if (!same) {
+	cerr << name << " differs from scalar for " << count << " projectiles" << endl;
+    }
+    CHECK(same);
+
+    for (int ii = offset; ii < int(batch.posx.size()); ii++) {
+	bounces += expected.vx[ii] != batch.vx[ii];
+	exits += expected.offScreen[ii];
+    }
+    return failures;
+}
+
+}
+
+int testProjectileStep() {
+    int failures = 0;
+    // the last type does not bounce, as the pool sets it up, so only
+    // it can reach the side exits
+    const float infinity = numeric_limits<float>::infinity();
+    const float left[typeCount] = { 5.0f, 0.0f, 12.5f, 5.0f, 30.0f, -infinity };
+    const float right[typeCount] = { 435.0f, 450.0f, 420.25f, 445.0f, 400.0f, infinity };
+    const float bottom[typeCount] = { 790.0f, 800.0f, 780.0f, 805.0f, 770.0f, 795.0f };
+    StepWalls walls;
+    walls.left = left;
+    walls.right = right;
+    walls.bottom = bottom;
+    walls.exitLeft = -10.0f;
+    walls.exitRight = 460.0f;
+    walls.exitTop = -20.0f;
+
+    const char* kernels[] = { "sse2", "avx" };
+    for (const char* name : kernels) {
+	if (!useStepKernel(name)) {
+	    cout << "skipping the " << name << " kernel, which this CPU lacks" << endl;
+	    continue;
+	}
+	CHECK(strcmp(stepKernelName(), name) == 0);
+
+	mt19937 random(20240601);
+	uniform_int_distribution<int> size(1, 203);
+	uniform_real_distribution<float> step(0.001f, 0.1f);
+	int bounces = 0;
+	int exits = 0;
+	for (int batch = 0; batch < 20000; batch++) {
+	    // counts are mostly not multiples of 4 or 8, leaving tails
+	    int count = size(random);
+	    int offset = batch % 3 == 0 && count > 1 ? 1 : 0;
+	    failures += compare(name, makeBatch(random, count, walls), offset, step(random),
+		walls, bounces, exits);
+	}
+
+	// the batches must actually exercise the walls and exits
+	CHECK(bounces > 0);
+	CHECK(exits > 0);
+    }
+    useStepKernel("scalar");
+    return failures;
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <stdexcept>
+
+#include "GameSession.h"
+#include "InputRecorder.h"
+#include "Tests.h"
+
+using namespace std;
+using namespace spacePig;
+
+namespace {
+
+/** where the test writes its recordings */
+const char* recordingPath = "SpacePigTests-replay.rec";
+
+/**
+ * Play a session for a number of steps with scripted input: the
+ * controls change every few dozen steps, the player is moved now and
+ * then, and the game restarts on death and skips each intermission.
+ */
+void play(GameSession& session, unsigned long long steps) {
+    static const unsigned directions[] = { Player::Left, Player::Up | Player::Right,
+	Player::Down, 0, Player::Right, Player::Left | Player::Down };
+    for (unsigned long long ii = 0; ii < steps; ii++) {
+	if (session.getState() == GameSession::State::Dead) {
+	    session.restart();
+	}
+	else if (session.getState() == GameSession::State::Intermission && ii % 90 == 0) {
+	    session.startNextWave();
+	}
+	if (ii % 37 == 0) {
+	    session.steerPlayer(directions[(ii / 37) % 6]);
+	}
+	if (ii % 500 == 250) {
+	    session.movePlayerTo(int(ii % 400) + 25, 600);
+	}
+	session.step();
+    }
+}
+
+}
+
+int testReplay() {
+    int failures = 0;
+
+    // A recorded game replays with every checkpoint matching
+
+    {
+	GameSession session(Player(), 60.0, 12345);
+	InputRecorder recorder;
+	CHECK(recorder.open(recordingPath, session.getSeed(), session.getTickRate(), 100));
+	session.setRecorder(&recorder);
+	session.restart();
+	play(session, 20000);
+	recorder.close(session.getTick());
+	session.setRecorder(nullptr);
+
+	ReplayResult result = replayInputs(recordingPath);
+	CHECK(result.ticks == session.getTick());
+	CHECK(result.commands > 0);
+	CHECK(result.checkpoints == 200);
+	CHECK(result.mismatches == 0);
+    }
+
+    // A checkpoint that does not match the session is reported, at
+    // the step it was taken
+
+    {
+	GameSession session(Player(), 60.0, 777);
+	InputRecorder recorder;
+	CHECK(recorder.open(recordingPath, session.getSeed(), session.getTickRate(), 0));
+	session.setRecorder(&recorder);
+	session.restart();
+	play(session, 250);
+	recorder.checkpoint(session.getTick(), session.getStateHash());
+	play(session, 250);
+	recorder.checkpoint(session.getTick(), session.getStateHash() ^ 1);
+	unsigned long long corrupted = session.getTick();
+	play(session, 100);
+	recorder.close(session.getTick());
+	session.setRecorder(nullptr);
+
+	ReplayResult result = replayInputs(recordingPath);
+	CHECK(result.checkpoints == 2);
+	CHECK(result.mismatches == 1);
+	CHECK(result.firstMismatch == corrupted);
+    }
+
+    // A file that is not a recording is refused
+
+    {
+	FILE* file = fopen(recordingPath, "wb");
+	fputs("not a recording", file);
+	fclose(file);
+	bool refused = false;
+	try {
+	    replayInputs(recordingPath);
+	}
+	catch (const domain_error&) {
+	    refused = true;
+	}
+	CHECK(refused);
+    }
+
+    remove(recordingPath);
+    return failures;
+}
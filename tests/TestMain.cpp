@@ -0,0 +1,46 @@
+#include <iostream>
+
+#include "Tests.h"
+
+using namespace std;
+
+int check(bool passed, const char* condition, const char* file, int line) {
+    if (!passed) {
+	cerr << file << ":" << line << ": check failed: " << condition << endl;
+    }
+    return passed ? 0 : 1;
+}
+
+/**
+ * Runs every unit test.
+ *
+ * usage: SpacePigTests
+ *
+ * @return The status code. Status code 0 means
+ * every test passed, and nonzero status code
+ * means at least one check failed.
+ */
+int main() {
+    struct Test {
+	const char* name;
+	int (*run)();
+    };
+    const Test tests[] = {
+	{ "projectile step", testProjectileStep },
+	{ "replay", testReplay },
+	{ "pattern", testPattern },
+	{ "collision", testCollision },
+    };
+
+    int failures = 0;
+    for (const Test& test : tests) {
+	int failed = test.run();
+	cout << (failed == 0 ? "pass " : "FAIL ") << test.name;
+	if (failed != 0) {
+	    cout << " (" << failed << " checks failed)";
+	}
+	cout << endl;
+	failures += failed;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#ifndef SPACEPIG_TESTS_H
+#define SPACEPIG_TESTS_H
+
+/**
+ * The unit tests, run by make test. Each test function checks one
+ * part of the game with CHECK and returns the number of checks that
+ * failed.
+ */
+
+/**
+ * Report a failed check.
+ * @return 1 if the check failed, 0 if it passed
+ */
+int check(/** whether the check passed */ bool passed,
+	/** the condition checked */ const char* condition,
+	/** the file of the check */ const char* file,
+	/** the line of the check */ int line);
+
+/** Check a condition, counting it in failures if it does not hold */
+#define CHECK(condition) (failures += check((condition), #condition, __FILE__, __LINE__))
+
+/**
+ * Every SIMD step kernel gives exactly the results of the scalar one.
+ * @return the number of failed checks
+ */
+int testProjectileStep();
+
+/**
+ * A recorded game replays with every checkpoint matching, and a
+ * checkpoint that does not match is reported.
+ * @return the number of failed checks
+ */
+int testReplay();
+
+/**
+ * The example patterns compile and emit what they spell out, and
+ * malformed pattern files are refused with a message.
+ * @return the number of failed checks
+ */
+int testPattern();
+
+/**
+ * A projectile that crosses the player within one tick is caught,
+ * also when it bounces off a wall partway through the tick.
+ * @return the number of failed checks
+ */
+int testCollision();
+
+#endif